@@ -0,0 +1,81 @@
+﻿// exp3和exp4共用的线程池
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 简单线程池：parallelFor把[0, count)逐个分给工作线程，调用方线程作为0号线程一起参与，
+// 全部完成后返回；fn的第二个参数是线程编号，用来选取线程私有的缓冲区
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable startCv, doneCv;
+    const std::function<void(size_t, int)>* job;
+    size_t count;
+    std::atomic<size_t> next;
+    int active;
+    uint64_t generation;
+    bool stopping;
+
+    void runJob(int id) {
+        for (size_t i = next++; i < count; i = next++) (*job)(i, id);
+    }
+
+    void workerLoop(int id) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                startCv.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runJob(id);
+            std::lock_guard<std::mutex> lock(m);
+            if (--active == 0) doneCv.notify_one();
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads)
+        : job(nullptr), count(0), next(0), active(0), generation(0), stopping(false) {
+        for (int id = 1; id < std::max(1, threads); ++id) workers.emplace_back(&ThreadPool::workerLoop, this, id);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        startCv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    void parallelFor(size_t n, const std::function<void(size_t, int)>& fn) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            job = &fn;
+            count = n;
+            next = 0;
+            active = static_cast<int>(workers.size());
+            ++generation;
+        }
+        startCv.notify_all();
+        runJob(0);
+        std::unique_lock<std::mutex> lock(m);
+        doneCv.wait(lock, [&]() { return active == 0; });
+    }
+};
+
+inline int defaultThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
@@ -4,6 +4,15 @@
 #include <algorithm>
 #include <ctime>
 #include <cstdlib>
+#include <cstdint>
+#include <climits>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <string>
+#include <iomanip>
 
 // 计算柱状图中矩形的最大面积
 int largestRectangleArea(std::vector<int>& heights) {
@@ -23,6 +32,428 @@ int largestRectangleArea(std::vector<int>& heights) {
     return maxArea;
 }
 
+// 单调栈求最大矩形的核心过程：不修改输入、不依赖哨兵，
+// 栈由调用方传入，便于在多次调用之间复用同一块内存
+long long histogramMaxArea(const int* heights, int n, std::vector<int>& stk) {
+    long long maxArea = 0;
+    stk.clear();
+    for (int i = 0; i <= n; ++i) {
+        int h = (i < n) ? heights[i] : 0; // 末尾视为高度0的柱子，清空栈中剩余柱子
+        while (!stk.empty() && heights[stk.back()] > h) {
+            long long height = heights[stk.back()];
+            stk.pop_back();
+            int width = stk.empty() ? i : i - stk.back() - 1;
+            maxArea = std::max(maxArea, height * width);
+        }
+        if (i < n) stk.push_back(i);
+    }
+    return maxArea;
+}
+
+// 按位压缩的0/1矩阵，每行占若干个64位字，第c列存放在第c/64个字的第c%64位
+class BitMatrix {
+private:
+    int nRows, nCols, nWords;
+    std::vector<uint64_t> bits;
+
+public:
+    BitMatrix(int rows, int cols)
+        : nRows(rows), nCols(cols), nWords((cols + 63) / 64),
+          bits(static_cast<size_t>(rows) * ((cols + 63) / 64), 0) {}
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    int wordsPerRow() const { return nWords; }
+
+    const uint64_t* row(int r) const { return &bits[static_cast<size_t>(r) * nWords]; }
+    uint64_t* row(int r) { return &bits[static_cast<size_t>(r) * nWords]; }
+
+    bool get(int r, int c) const { return (row(r)[c >> 6] >> (c & 63)) & 1; }
+
+    void set(int r, int c, bool v) {
+        uint64_t mask = 1ULL << (c & 63);
+        if (v) row(r)[c >> 6] |= mask;
+        else row(r)[c >> 6] &= ~mask;
+    }
+};
+
+// 0/1矩阵中全1矩形的最大面积：逐行累计高度后复用柱状图算法，
+// 整个过程只使用一个高度缓冲区和一个栈
+long long maximalRectangle(const std::vector<std::vector<int>>& matrix) {
+    if (matrix.empty()) return 0;
+    int cols = static_cast<int>(matrix[0].size());
+    std::vector<int> heights(cols, 0);
+    std::vector<int> stk;
+    stk.reserve(cols);
+    long long maxArea = 0;
+    for (const auto& row : matrix) {
+        for (int j = 0; j < cols; ++j) {
+            heights[j] = row[j] ? heights[j] + 1 : 0;
+        }
+        maxArea = std::max(maxArea, histogramMaxArea(heights.data(), cols, stk));
+    }
+    return maxArea;
+}
+
+// 位压缩矩阵逐行求解时每列的状态：height为该列向上连续1的个数，
+// [left, right)为以height为高、包含该列的全1矩形最宽能占据的列区间；
+// 该列为0时状态为{0, 0, cols}，这也是矩阵第一行之前的初始状态
+struct ColumnSpans {
+    std::vector<int> height, left, right;
+    explicit ColumnSpans(int cols) : height(cols, 0), left(cols, 0), right(cols, cols) {}
+};
+
+// 用一行的位串推进各列的状态，返回这一行上以各列状态为界的矩形的最大面积。
+// 不用单调栈：从左到右一遍更新height和left，从右到左一遍更新right并计算面积，
+// 位串按字读入，每一位展开成全0或全1的掩码，循环体内没有依赖数据的分支
+static long long advanceRow(const uint64_t* row, int cols, ColumnSpans& s) {
+    int* h = s.height.data();
+    int* l = s.left.data();
+    int* r = s.right.data();
+    int words = (cols + 63) / 64;
+    int runStart = 0; // 本行当前这段连续1的起始列
+    for (int w = 0; w < words; ++w) {
+        uint64_t word = row[w];
+        int base = w * 64;
+        int cnt = std::min(64, cols - base);
+        for (int k = 0; k < cnt; ++k) {
+            int j = base + k;
+            int mask = -static_cast<int>((word >> k) & 1);
+            runStart = (runStart & mask) | ((j + 1) & ~mask);
+            h[j] = (h[j] + 1) & mask;
+            l[j] = std::max(l[j], runStart) & mask;
+        }
+    }
+    long long maxArea = 0;
+    int runEnd = cols; // 本行当前这段连续1的结束列（不含）
+    for (int w = words - 1; w >= 0; --w) {
+        uint64_t word = row[w];
+        int base = w * 64;
+        int cnt = std::min(64, cols - base);
+        for (int k = cnt - 1; k >= 0; --k) {
+            int j = base + k;
+            int mask = -static_cast<int>((word >> k) & 1);
+            runEnd = (runEnd & mask) | (j & ~mask);
+            r[j] = (std::min(r[j], runEnd) & mask) | (cols & ~mask);
+            maxArea = std::max(maxArea, static_cast<long long>(r[j] - l[j]) * h[j]);
+        }
+    }
+    return maxArea;
+}
+
+// 处理[r0, r1)行带，spans传入进入该行带之前各列的状态
+static long long maximalRectangleBand(const BitMatrix& m, int r0, int r1, ColumnSpans& spans) {
+    long long maxArea = 0;
+    for (int r = r0; r < r1; ++r) {
+        maxArea = std::max(maxArea, advanceRow(m.row(r), m.cols(), spans));
+    }
+    return maxArea;
+}
+
+// 位压缩矩阵版本，threads > 1 时按行分带并行：
+// 第一遍各行带从初始状态开始推进，得到带底各列的状态；
+// 合并时顺序推出每个行带的初始状态（整列全1则高度在上一带的基础上累加，
+// 左右边界分别与上一带取max和min）；
+// 第二遍各行带带着初始状态独立求解，结果取最大值
+long long maximalRectangle(const BitMatrix& m, int threads = 1) {
+    int rows = m.rows(), cols = m.cols();
+    if (rows == 0 || cols == 0) return 0;
+    threads = std::max(1, std::min(threads, rows));
+    if (threads == 1) {
+        ColumnSpans spans(cols);
+        return maximalRectangleBand(m, 0, rows, spans);
+    }
+
+    std::vector<int> bandStart(threads + 1);
+    for (int b = 0; b <= threads; ++b) {
+        bandStart[b] = static_cast<int>(static_cast<long long>(rows) * b / threads);
+    }
+
+    // 第一遍：每个行带底部各列的状态
+    std::vector<ColumnSpans> bottom(threads, ColumnSpans(cols));
+    std::vector<std::thread> workers;
+    for (int b = 0; b < threads; ++b) {
+        workers.emplace_back([&, b]() {
+            maximalRectangleBand(m, bandStart[b], bandStart[b + 1], bottom[b]);
+        });
+    }
+    for (auto& t : workers) t.join();
+    workers.clear();
+
+    // 合并：由上一带的初始状态和底部状态推出下一带的初始状态
+    std::vector<ColumnSpans> initial(threads, ColumnSpans(cols));
+    for (int b = 0; b + 1 < threads; ++b) {
+        int bandRows = bandStart[b + 1] - bandStart[b];
+        const ColumnSpans& prev = initial[b];
+        const ColumnSpans& bot = bottom[b];
+        ColumnSpans& next = initial[b + 1];
+        for (int j = 0; j < cols; ++j) {
+            if (bot.height[j] == bandRows) {
+                next.height[j] = prev.height[j] + bandRows;
+                next.left[j] = std::max(prev.left[j], bot.left[j]);
+                next.right[j] = std::min(prev.right[j], bot.right[j]);
+            } else {
+                next.height[j] = bot.height[j];
+                next.left[j] = bot.left[j];
+                next.right[j] = bot.right[j];
+            }
+        }
+    }
+
+    // 第二遍：各行带独立求解
+    std::vector<long long> best(threads, 0);
+    for (int b = 0; b < threads; ++b) {
+        workers.emplace_back([&, b]() {
+            best[b] = maximalRectangleBand(m, bandStart[b], bandStart[b + 1], initial[b]);
+        });
+    }
+    for (auto& t : workers) t.join();
+    return *std::max_element(best.begin(), best.end());
+}
+
+// 流式柱状图：柱子逐个到达，跨调用维护单调栈，不保存已出栈的柱子
+class StreamingHistogram {
+private:
+    struct Bar {
+        long long start; // 该高度能向左延伸到的最左位置
+        int height;
+    };
+    std::vector<Bar> stk;   // 高度严格递增
+    long long count;        // 已接收的柱子数
+    long long closedMax;    // 已出栈柱子所确定矩形的最大面积
+
+public:
+    StreamingHistogram() : count(0), closedMax(0) {}
+
+    void push(int height) {
+        long long start = count;
+        while (!stk.empty() && stk.back().height >= height) {
+            const Bar& top = stk.back();
+            closedMax = std::max(closedMax, static_cast<long long>(top.height) * (count - top.start));
+            start = top.start;
+            stk.pop_back();
+        }
+        stk.push_back({ start, height });
+        ++count;
+    }
+
+    // 目前为止见过的最大矩形面积，栈中柱子按延伸到当前末尾计算，代价为栈深度
+    long long currentMax() const {
+        long long best = closedMax;
+        for (const Bar& bar : stk) {
+            best = std::max(best, static_cast<long long>(bar.height) * (count - bar.start));
+        }
+        return best;
+    }
+
+    long long size() const { return count; }
+
+    void reset() {
+        stk.clear();
+        count = 0;
+        closedMax = 0;
+    }
+};
+
+// 滑动窗口版本：只考虑最近W根柱子，用环形缓冲区保存窗口，内存固定为O(W)；
+// push为O(1)，currentMax在窗口变化后按需重算一次并缓存结果
+class SlidingWindowHistogram {
+private:
+    std::vector<int> ring;     // 环形缓冲区，容量为窗口大小
+    std::vector<int> linear;   // 重算时按时间顺序展开的窗口
+    std::vector<int> stk;      // 重算时复用的栈
+    long long count;
+    long long cached;
+    bool dirty;
+
+public:
+    explicit SlidingWindowHistogram(int window)
+        : ring(std::max(1, window)), count(0), cached(0), dirty(false) {
+        linear.reserve(ring.size());
+        stk.reserve(ring.size());
+    }
+
+    void push(int height) {
+        ring[count % ring.size()] = height;
+        ++count;
+        dirty = true;
+    }
+
+    long long currentMax() {
+        if (!dirty) return cached;
+        int n = static_cast<int>(std::min<long long>(count, ring.size()));
+        int head = static_cast<int>(count % ring.size()); // 窗口中最早的柱子
+        linear.clear();
+        if (n == static_cast<int>(ring.size())) {
+            linear.insert(linear.end(), ring.begin() + head, ring.end());
+            linear.insert(linear.end(), ring.begin(), ring.begin() + head);
+        } else {
+            linear.insert(linear.end(), ring.begin(), ring.begin() + n);
+        }
+        cached = histogramMaxArea(linear.data(), n, stk);
+        dirty = false;
+        return cached;
+    }
+
+    int window() const { return static_cast<int>(ring.size()); }
+};
+
+// 各分块最小值上的线段树，用于跨块查找第一个高度更小的柱子所在的块
+class BlockMinTree {
+private:
+    int size;
+    std::vector<int> t;
+
+    int lastBefore(int node, int l, int r, int pos, int x) const {
+        if (l >= pos || t[node] >= x) return -1;
+        if (r - l == 1) return l;
+        int mid = (l + r) / 2;
+        int res = lastBefore(node * 2 + 1, mid, r, pos, x);
+        return res != -1 ? res : lastBefore(node * 2, l, mid, pos, x);
+    }
+
+    int firstAfter(int node, int l, int r, int pos, int x) const {
+        if (r <= pos + 1 || t[node] >= x) return -1;
+        if (r - l == 1) return l;
+        int mid = (l + r) / 2;
+        int res = firstAfter(node * 2, l, mid, pos, x);
+        return res != -1 ? res : firstAfter(node * 2 + 1, mid, r, pos, x);
+    }
+
+public:
+    explicit BlockMinTree(const std::vector<int>& mins) : size(1) {
+        while (size < static_cast<int>(mins.size())) size *= 2;
+        t.assign(2 * size, INT_MAX);
+        for (size_t i = 0; i < mins.size(); ++i) t[size + i] = mins[i];
+        for (int i = size - 1; i > 0; --i) t[i] = std::min(t[2 * i], t[2 * i + 1]);
+    }
+
+    // 下标小于pos的块中，最靠右且最小值小于x的块，不存在时返回-1
+    int lastBefore(int pos, int x) const { return lastBefore(1, 0, size, pos, x); }
+
+    // 下标大于pos的块中，最靠左且最小值小于x的块，不存在时返回-1
+    int firstAfter(int pos, int x) const { return firstAfter(1, 0, size, pos, x); }
+};
+
+// 分块的边界摘要：从左、从右扫描该块后单调栈中剩下的柱子，
+// 即块内严格前缀最小值和严格后缀最小值的位置（相对块起点）
+struct ChunkSummary {
+    size_t begin, end;
+    int minHeight;
+    std::vector<uint32_t> prefixMin; // 位置递增，高度严格递减
+    std::vector<uint32_t> suffixMin; // 位置递增，高度严格递增
+};
+
+static void summarizeChunk(const int* h, ChunkSummary& c) {
+    int mn = INT_MAX;
+    for (size_t i = c.begin; i < c.end; ++i) {
+        if (h[i] < mn) {
+            mn = h[i];
+            c.prefixMin.push_back(static_cast<uint32_t>(i - c.begin));
+        }
+    }
+    c.minHeight = mn;
+    mn = INT_MAX;
+    for (size_t i = c.end; i-- > c.begin;) {
+        if (h[i] < mn) {
+            mn = h[i];
+            c.suffixMin.push_back(static_cast<uint32_t>(i - c.begin));
+        }
+    }
+    std::reverse(c.suffixMin.begin(), c.suffixMin.end());
+}
+
+// 并行分治求柱状图最大矩形：
+// 1. 各块并行计算边界摘要，并在块最小值上建线段树；
+// 2. 各块并行地做一遍单调栈，柱子出栈时得到左右两侧第一根更矮柱子的位置，
+//    块内找不到时先用线段树找到目标块，再在该块的边界摘要上二分；
+// 3. 每根柱子以自身高度向两侧延伸得到的面积取最大值，与串行结果完全一致
+long long largestRectangleAreaParallel(const std::vector<int>& heights, int threads,
+                                       size_t chunkSize = 0) {
+    size_t n = heights.size();
+    if (n == 0) return 0;
+    threads = std::max(1, threads);
+    if (chunkSize == 0) {
+        // 块数取线程数的若干倍以平衡负载
+        chunkSize = std::max<size_t>(1 << 16, (n + threads * 8 - 1) / (threads * 8));
+    }
+    chunkSize = std::min<size_t>(chunkSize, UINT32_MAX);
+    const int* h = heights.data();
+    int chunkCount = static_cast<int>((n + chunkSize - 1) / chunkSize);
+    threads = std::min(threads, chunkCount);
+
+    std::vector<ChunkSummary> chunks(chunkCount);
+    for (int c = 0; c < chunkCount; ++c) {
+        chunks[c].begin = c * chunkSize;
+        chunks[c].end = std::min(n, (c + 1) * chunkSize);
+    }
+
+    auto runParallel = [&](const std::function<void(int, std::vector<uint32_t>&)>& job) {
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            std::vector<uint32_t> stk; // 每个线程复用的栈，保存块内偏移
+            for (int c = next++; c < chunkCount; c = next++) job(c, stk);
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+    };
+
+    runParallel([&](int c, std::vector<uint32_t>&) {
+        summarizeChunk(h, chunks[c]);
+    });
+
+    std::vector<int> mins(chunkCount);
+    for (int c = 0; c < chunkCount; ++c) mins[c] = chunks[c].minHeight;
+    BlockMinTree tree(mins);
+
+    // 块外左侧第一根比x矮的柱子的下一个位置，不存在时为0
+    auto resolveLeft = [&](int c, int x) -> size_t {
+        int b = tree.lastBefore(c, x);
+        if (b < 0) return 0;
+        const ChunkSummary& s = chunks[b];
+        auto it = std::partition_point(s.suffixMin.begin(), s.suffixMin.end(),
+            [&](uint32_t off) { return h[s.begin + off] < x; });
+        return s.begin + *(it - 1) + 1;
+    };
+
+    // 块外右侧第一根比x矮的柱子的位置，不存在时为n
+    auto resolveRight = [&](int c, int x) -> size_t {
+        int b = tree.firstAfter(c, x);
+        if (b < 0) return n;
+        const ChunkSummary& s = chunks[b];
+        auto it = std::partition_point(s.prefixMin.begin(), s.prefixMin.end(),
+            [&](uint32_t off) { return h[s.begin + off] >= x; });
+        return s.begin + *it;
+    };
+
+    std::vector<long long> best(chunkCount, 0);
+    runParallel([&](int c, std::vector<uint32_t>& stk) {
+        size_t begin = chunks[c].begin;
+        uint32_t len = static_cast<uint32_t>(chunks[c].end - begin);
+        const int* hc = h + begin;
+        long long maxArea = 0;
+        // 栈中高度严格递增，栈顶之下即为左侧第一根更矮的柱子；
+        // 出栈时右边界可能是等高柱子，但同高度中最后一根的左右边界都是准确的
+        auto popArea = [&](size_t right) {
+            uint32_t top = stk.back();
+            stk.pop_back();
+            size_t left = stk.empty() ? resolveLeft(c, hc[top]) : begin + stk.back() + 1;
+            maxArea = std::max(maxArea, static_cast<long long>(hc[top]) * static_cast<long long>(right - left));
+        };
+        stk.clear();
+        for (uint32_t i = 0; i < len; ++i) {
+            while (!stk.empty() && hc[stk.back()] >= hc[i]) popArea(begin + i);
+            stk.push_back(i);
+        }
+        // 留在栈中的柱子右边界在块外
+        while (!stk.empty()) popArea(resolveRight(c, hc[stk.back()]));
+        best[c] = maxArea;
+    });
+    return *std::max_element(best.begin(), best.end());
+}
+
 // 随机生成柱状图高度
 std::vector<int> generateRandomHeights(int length) {
     std::vector<int> heights(length);
@@ -32,7 +463,205 @@ std::vector<int> generateRandomHeights(int length) {
     return heights;
 }
 
-int main() {
+// 对拍测试使用的输入形态
+enum class Pattern { Random, Sorted, Reversed, AllEqual, Sawtooth };
+
+const char* patternName(Pattern p) {
+    switch (p) {
+    case Pattern::Random:   return "random";
+    case Pattern::Sorted:   return "sorted";
+    case Pattern::Reversed: return "reversed";
+    case Pattern::AllEqual: return "all-equal";
+    default:                return "sawtooth";
+    }
+}
+
+// 按指定形态生成高度在[0, maxHeight)之间的柱状图，使用固定种子的生成器以便复现
+std::vector<int> generateHeights(Pattern p, int length, int maxHeight, std::mt19937& gen) {
+    std::uniform_int_distribution<int> dis(0, maxHeight - 1);
+    std::vector<int> heights(length);
+    int period = 1 + static_cast<int>(gen() % 8);
+    int level = dis(gen);
+    for (int i = 0; i < length; ++i) {
+        switch (p) {
+        case Pattern::AllEqual: heights[i] = level; break;
+        case Pattern::Sawtooth: heights[i] = (i % period) * (maxHeight - 1) / period; break;
+        default:                heights[i] = dis(gen); break;
+        }
+    }
+    if (p == Pattern::Sorted) std::sort(heights.begin(), heights.end());
+    if (p == Pattern::Reversed) std::sort(heights.rbegin(), heights.rend());
+    return heights;
+}
+
+// O(n^2)暴力解法，作为对拍的标准答案
+long long bruteForceArea(const std::vector<int>& heights) {
+    long long maxArea = 0;
+    for (size_t i = 0; i < heights.size(); ++i) {
+        int minHeight = INT_MAX;
+        for (size_t j = i; j < heights.size(); ++j) {
+            minHeight = std::min(minHeight, heights[j]);
+            maxArea = std::max(maxArea, static_cast<long long>(minHeight) * static_cast<long long>(j - i + 1));
+        }
+    }
+    return maxArea;
+}
+
+// 0/1矩阵的暴力解法：枚举上下边界，求这些行上全为1的最长连续列段
+long long bruteForceMatrix(const std::vector<std::vector<int>>& matrix) {
+    long long maxArea = 0;
+    size_t cols = matrix.empty() ? 0 : matrix[0].size();
+    for (size_t top = 0; top < matrix.size(); ++top) {
+        std::vector<int> allOnes(cols, 1);
+        for (size_t bottom = top; bottom < matrix.size(); ++bottom) {
+            long long run = 0;
+            for (size_t c = 0; c < cols; ++c) {
+                allOnes[c] &= matrix[bottom][c] != 0;
+                run = allOnes[c] ? run + 1 : 0;
+                maxArea = std::max(maxArea, run * static_cast<long long>(bottom - top + 1));
+            }
+        }
+    }
+    return maxArea;
+}
+
+// 随机0/1矩阵上对拍两个maximalRectangle版本：列数跨过64位字的边界，
+// 密度较高时整列全1会跨越多个行带，覆盖分带并行的合并；线程数可以超过行数
+static bool runMatrixTests(std::mt19937& gen, unsigned seed, int& cases) {
+    const double densities[] = { 0.3, 0.7, 0.95, 1.0 };
+    for (double density : densities) {
+        std::bernoulli_distribution bit(density);
+        for (int k = 0; k < 60; ++k) {
+            int rows = static_cast<int>(gen() % 41), cols = static_cast<int>(gen() % 151);
+            std::vector<std::vector<int>> matrix(rows, std::vector<int>(cols));
+            BitMatrix packed(rows, cols);
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    matrix[r][c] = bit(gen) ? 1 : 0;
+                    packed.set(r, c, matrix[r][c] != 0);
+                }
+            }
+            long long expected = bruteForceMatrix(matrix);
+            int threads = 1 + static_cast<int>(gen() % 8);
+            long long results[] = { maximalRectangle(matrix), maximalRectangle(packed, 1),
+                                    maximalRectangle(packed, threads) };
+            const char* names[] = { "maximalRectangle", "maximalRectangle(BitMatrix)",
+                                    "maximalRectangle(BitMatrix, threads)" };
+            for (int r = 0; r < 3; ++r) {
+                if (results[r] != expected) {
+                    std::cout << "FAILED: " << names[r] << " on " << rows << "x" << cols
+                              << " matrix, density " << density << ", " << threads << " threads, seed "
+                              << seed << ": got " << results[r] << ", expected " << expected << "\n";
+                    return false;
+                }
+            }
+            ++cases;
+        }
+    }
+    return true;
+}
+
+// 随机窗口大小下逐个推入柱子，在随机时刻把SlidingWindowHistogram与最近W根柱子的暴力解对拍，
+// 连续查询两次以覆盖缓存的结果
+static bool runWindowTests(std::mt19937& gen, unsigned seed, int& cases) {
+    for (int k = 0; k < 100; ++k) {
+        int window = 1 + static_cast<int>(gen() % 64);
+        int maxHeight = (k % 2 == 0) ? 10 : 1000;
+        SlidingWindowHistogram windowed(window);
+        std::vector<int> all = generateHeights(Pattern::Random, static_cast<int>(gen() % 300), maxHeight, gen);
+        for (size_t i = 0; i < all.size(); ++i) {
+            windowed.push(all[i]);
+            if (gen() % 4 != 0) continue;
+            size_t first = i + 1 > static_cast<size_t>(window) ? i + 1 - window : 0;
+            std::vector<int> recent(all.begin() + first, all.begin() + i + 1);
+            long long expected = bruteForceArea(recent);
+            long long got = windowed.currentMax();
+            if (got != expected || windowed.currentMax() != expected) {
+                std::cout << "FAILED: SlidingWindowHistogram, window " << window << ", after " << i + 1
+                          << " bars, seed " << seed << ": got " << got << ", expected " << expected << "\n";
+                return false;
+            }
+        }
+        ++cases;
+    }
+    return true;
+}
+
+// 各种形态的随机输入上，将所有实现与暴力解法对拍，返回是否全部通过
+bool runDifferentialTests(unsigned seed) {
+    std::mt19937 gen(seed);
+    const Pattern patterns[] = { Pattern::Random, Pattern::Sorted, Pattern::Reversed,
+                                 Pattern::AllEqual, Pattern::Sawtooth };
+    const int maxHeights[] = { 1, 10, 1000 };
+    std::vector<int> stk;
+    int cases = 0;
+    for (Pattern p : patterns) {
+        for (int maxHeight : maxHeights) {
+            for (int k = 0; k < 100; ++k) {
+                int length = static_cast<int>(gen() % 257);
+                std::vector<int> heights = generateHeights(p, length, maxHeight, gen);
+                long long expected = bruteForceArea(heights);
+
+                StreamingHistogram stream;
+                for (int h : heights) stream.push(h);
+                size_t chunkSize = 1 + gen() % 8;
+                long long results[] = {
+                    largestRectangleArea(heights),
+                    histogramMaxArea(heights.data(), length, stk),
+                    largestRectangleAreaParallel(heights, 3, chunkSize),
+                    stream.currentMax()
+                };
+                const char* names[] = { "largestRectangleArea", "histogramMaxArea",
+                                        "largestRectangleAreaParallel", "StreamingHistogram" };
+                for (int r = 0; r < 4; ++r) {
+                    if (results[r] != expected) {
+                        std::cout << "FAILED: " << names[r] << " on " << patternName(p)
+                                  << " input, length " << length << ", seed " << seed
+                                  << ": got " << results[r] << ", expected " << expected << "\n";
+                        return false;
+                    }
+                }
+                ++cases;
+            }
+        }
+    }
+    if (!runMatrixTests(gen, seed, cases) || !runWindowTests(gen, seed, cases)) return false;
+    std::cout << "Differential tests passed: " << cases << " cases (seed " << seed << ")\n";
+    return true;
+}
+
+// 吞吐量测试：柱子数从10^3增长到maxBars，报告每秒处理的柱子数
+void runBenchmark(size_t maxBars) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> dis(0, 999);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    long long checksum = 0;
+    std::cout << std::setw(12) << "bars" << std::setw(20) << "serial bars/s"
+              << std::setw(24) << "parallel bars/s" << "  (" << threads << " threads)\n";
+    for (size_t n = 1000; n <= maxBars; n *= 10) {
+        std::vector<int> heights;
+        heights.reserve(n + 1); // largestRectangleArea会临时追加一个哨兵
+        for (size_t i = 0; i < n; ++i) heights.push_back(dis(gen));
+        // 小规模时重复多次，使每组计时的总柱子数相当
+        size_t reps = std::max<size_t>(1, 100000000 / n);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r) checksum += largestRectangleArea(heights);
+        auto t1 = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r) checksum += largestRectangleAreaParallel(heights, threads);
+        auto t2 = std::chrono::steady_clock::now();
+
+        double bars = static_cast<double>(n) * reps;
+        double serial = bars / std::chrono::duration<double>(t1 - t0).count();
+        double parallel = bars / std::chrono::duration<double>(t2 - t1).count();
+        std::cout << std::setw(12) << n << std::setw(20) << std::scientific << std::setprecision(3)
+                  << serial << std::setw(24) << parallel << std::defaultfloat << "\n";
+    }
+    std::cout << "checksum " << checksum << "\n";
+}
+
+// 原有的演示：随机小规模测试和各扩展功能的示例
+void runDemo() {
     srand(static_cast<unsigned>(time(0))); // 初始化随机数种子
 
     // 进行10组测试
@@ -50,6 +679,53 @@ int main() {
         std::cout << "Maximum Rectangle Area = " << maxArea << "\n\n";
     }
 
-    return 0;
+    // 0/1矩阵中的最大全1矩形
+    std::vector<std::vector<int>> matrix = {
+        {1, 0, 1, 0, 0},
+        {1, 0, 1, 1, 1},
+        {1, 1, 1, 1, 1},
+        {1, 0, 0, 1, 0}
+    };
+    BitMatrix packed(4, 5);
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 5; ++c) packed.set(r, c, matrix[r][c] != 0);
+    }
+    std::cout << "Maximal Rectangle in Matrix = " << maximalRectangle(matrix) << "\n";
+    std::cout << "Maximal Rectangle (bit-packed, 2 bands) = " << maximalRectangle(packed, 2) << "\n";
+
+    // 流式处理：逐个推入柱子，不缓存整个序列
+    StreamingHistogram stream;
+    SlidingWindowHistogram windowed(4);
+    std::vector<int> streamed = { 2, 1, 5, 6, 2, 3 };
+    for (int h : streamed) {
+        stream.push(h);
+        windowed.push(h);
+    }
+    std::cout << "Streaming Maximum = " << stream.currentMax()
+              << ", Last 4 Bars Maximum = " << windowed.currentMax() << "\n";
+
+    // 大规模柱状图的并行求解
+    std::vector<int> large = generateRandomHeights(1000000);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Large Histogram (10^6 bars): serial = " << largestRectangleArea(large)
+              << ", parallel (" << threads << " threads) = "
+              << largestRectangleAreaParallel(large, threads) << "\n\n";
 }
 
+// 用法：BarchartArea                  演示并运行对拍测试
+//       BarchartArea test [seed]      只运行对拍测试
+//       BarchartArea bench [maxBars]  吞吐量测试，默认最大10^8根柱子
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "bench") {
+        size_t maxBars = argc > 2 ? std::stoull(argv[2]) : 100000000;
+        runBenchmark(maxBars);
+        return 0;
+    }
+    if (mode == "test") {
+        unsigned seed = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 2024;
+        return runDifferentialTests(seed) ? 0 : 1;
+    }
+    runDemo();
+    return runDifferentialTests(2024) ? 0 : 1;
+}
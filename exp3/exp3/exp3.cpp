@@ -5,6 +5,23 @@
 #include <vector>
 #include <map>
 #include <cctype>
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "../../common/mapped_file.h"
+#include "../../common/thread_pool.h"
 using namespace std;
 
 // 1. 二叉树节点结构
@@ -49,63 +66,528 @@ public:
     }
 };
 
-// 3. 用于优先队列的比较器
-struct CompareNodes {
-    bool operator()(BinTreeNode* a, BinTreeNode* b) {
-        return a->weight > b->weight;
+// 3. 基于数组的Huffman树构造：所有节点放在一个可复用的数组里，孩子用下标表示，
+// 反复构造时不再分配内存；只求出每个字符的编码长度
+class HuffBuilder {
+public:
+    struct Node {
+        uint64_t weight;
+        int left, right;    // 叶子的left为-1，right为字符
+    };
+
+private:
+    vector<Node> nodes;     // 前n个是按权重升序的叶子，之后依次是合并出的内部节点
+    vector<int> depth;
+    vector<uint64_t> keys;  // 排序用：权重 << 16 | 字符
+    vector<int> sortedSymbols;
+    vector<uint64_t> sortedWeights;
+
+public:
+    // 叶子已按权重升序排好时的线性时间构造：叶子和新建的内部节点各自构成有序队列，
+    // 内部节点的权重是单调不减的，每次只需比较两个队首
+    void buildSorted(const int* symbols, const uint64_t* weights, int n, uint8_t* lengths) {
+        nodes.resize(2 * n - 1);
+        for (int i = 0; i < n; ++i) nodes[i] = { weights[i], -1, symbols[i] };
+        if (n == 1) {
+            lengths[symbols[0]] = 1;
+            return;
+        }
+        int leaf = 0, inner = n, next = n;
+        auto pick = [&]() -> int {
+            bool takeLeaf = leaf < n && (inner >= next || nodes[leaf].weight <= nodes[inner].weight);
+            return takeLeaf ? leaf++ : inner++;
+        };
+        for (; next < 2 * n - 1; ++next) {
+            int a = pick();
+            int b = pick();
+            nodes[next] = { nodes[a].weight + nodes[b].weight, a, b };
+        }
+        // 孩子的下标总小于父节点，从根往下逆序扫描即可得到深度
+        depth.assign(nodes.size(), 0);
+        for (int k = static_cast<int>(nodes.size()) - 1; k >= n; --k) {
+            depth[nodes[k].left] = depth[k] + 1;
+            depth[nodes[k].right] = depth[k] + 1;
+        }
+        for (int i = 0; i < n; ++i) lengths[symbols[i]] = static_cast<uint8_t>(depth[i]);
+    }
+
+    // 任意顺序的频率表：把频率大于0的字符排序后构造，未出现的字符长度为0
+    void computeLengths(const uint64_t* freq, int numSymbols, uint8_t* lengths) {
+        keys.clear();
+        for (int i = 0; i < numSymbols; ++i) {
+            lengths[i] = 0;
+            if (freq[i]) keys.push_back((freq[i] << 16) | static_cast<uint64_t>(i));
+        }
+        sort(keys.begin(), keys.end());
+        sortedSymbols.resize(keys.size());
+        sortedWeights.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sortedSymbols[i] = static_cast<int>(keys[i] & 0xffff);
+            sortedWeights[i] = keys[i] >> 16;
+        }
+        if (!keys.empty()) {
+            buildSorted(sortedSymbols.data(), sortedWeights.data(), static_cast<int>(keys.size()), lengths);
+        }
     }
+
+    const vector<Node>& tree() const { return nodes; }
 };
 
-// 4. Huffman树类
-class HuffTree : public BinTree {
+// 4. 位输出缓冲：编码先累积在64位缓冲区中，攒够后按字节刷到字节数组，高位在前
+class BitWriter {
 private:
-    map<char, string> huffmanCodes;  // 存储每个字符的Huffman编码
+    vector<uint8_t> bytes;
+    size_t used;         // bytes中已写入的字节数，finish时截断到这个长度
+    uint64_t buffer;     // 低count位是尚未输出的位
+    int count;
+    size_t totalBits;
 
-    // 递归生成Huffman编码
-    void generateCodes(BinTreeNode* node, string code) {
-        if (node) {
-            if (isLeaf(node)) {
-                huffmanCodes[node->data] = code;
+    void flushBytes() {
+        if (used + 8 > bytes.size()) bytes.resize(max<size_t>(bytes.size() * 2, used + 64));
+        uint8_t* p = &bytes[used];
+        int n = count >> 3;
+        for (int i = 0; i < n; ++i) {
+            count -= 8;
+            p[i] = static_cast<uint8_t>(buffer >> count);
+        }
+        used += n;
+    }
+
+public:
+    BitWriter() : used(0), buffer(0), count(0), totalBits(0) {}
+
+    // 写入bits的低len位，len不超过56
+    void write(uint64_t bits, int len) {
+        if (count + len > 64) flushBytes();
+        buffer = (buffer << len) | bits;
+        count += len;
+        totalBits += len;
+    }
+
+    // 输出剩余的位，最后一个字节低位补0
+    void finish() {
+        flushBytes();
+        bytes.resize(used);
+        if (count > 0) {
+            bytes.push_back(static_cast<uint8_t>(buffer << (8 - count)));
+            count = 0;
+            ++used;
+        }
+    }
+
+    void reserve(size_t n) {
+        if (n + 8 > bytes.size()) bytes.resize(n + 8);
+    }
+
+    // 取走已经凑满的整字节追加到out，不足一字节的位留在缓冲区中，用于边编码边输出；
+    // 取走的字节不再出现在data()中
+    void drain(vector<uint8_t>& out) {
+        flushBytes();
+        out.insert(out.end(), bytes.begin(), bytes.begin() + used);
+        used = 0;
+    }
+
+    // 已写出的字节（需先调用finish）
+    const vector<uint8_t>& data() const { return bytes; }
+    size_t bitCount() const { return totalBits; }
+
+    // 以'0'/'1'字符串形式显示已写入的位（需先调用finish）
+    string toString() const {
+        string result;
+        for (size_t i = 0; i < totalBits; ++i) {
+            result += ((bytes[i / 8] >> (7 - i % 8)) & 1) ? '1' : '0';
+        }
+        return result;
+    }
+};
+
+// 5. 位输入缓冲：每次补充时一次读入8个字节，保证缓冲区中至少有56位可用，高位在前
+class BitReader {
+private:
+    const uint8_t* cur;
+    const uint8_t* end;
+    uint64_t buffer;     // 高bitsAvail位是尚未读取的位
+    int bitsAvail;
+
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : cur(data), end(data + size), buffer(0), bitsAvail(0) {}
+
+    // 输入结束后按0补齐，由调用方根据符号数决定何时停止
+    void refill() {
+        if (end - cur >= 8) {
+            uint64_t word = 0;
+            for (int i = 0; i < 8; ++i) word = (word << 8) | cur[i];
+            // 多读入的不完整字节下次会在相同位置再次读入，或运算结果不变
+            buffer |= word >> bitsAvail;
+            cur += (63 - bitsAvail) >> 3;
+            bitsAvail |= 56;
+        } else {
+            while (bitsAvail <= 56) {
+                uint64_t byte = (cur < end) ? *cur++ : 0;
+                buffer |= byte << (56 - bitsAvail);
+                bitsAvail += 8;
             }
-            generateCodes(node->left, code + "0");
-            generateCodes(node->right, code + "1");
         }
     }
 
+    // 查看接下来的n位（1 <= n <= 56），需先refill
+    uint64_t peek(int n) const { return buffer >> (64 - n); }
+    void consume(int n) {
+        buffer <<= n;
+        bitsAvail -= n;
+    }
+};
+
+// 6. 多级查表解码器：根表一次查kRootBits位，更长的编码转入子表，每级子表最多查kSubBits位；
+// 表项为 (值 << 8) | (位数 << 1) | 是否子表，叶子的值是字符、位数是本级消耗的位数，
+// 子表项的值是子表起点、位数是子表的宽度，位数为0的叶子表示非法编码
+class HuffDecoder {
+private:
+    static const int kRootBits = 10;
+    static const int kSubBits = 8;
+
+    vector<uint32_t> table;
+    int rootBits;
+    int symbolsPerRefill;   // 补充一次输入（至少56位）后可以连续解码的字符数
+
+    // 建表时使用的临时前缀树
+    struct TrieNode {
+        int child[2];
+        int symbol;
+        int depth;   // 以该节点为根的子树高度
+    };
+    vector<TrieNode> trie;
+
+    int newTrieNode() {
+        trie.push_back({ { -1, -1 }, -1, 0 });
+        return static_cast<int>(trie.size()) - 1;
+    }
+
+    int computeDepth(int node) {
+        int d = 0;
+        for (int b = 0; b < 2; ++b) {
+            if (trie[node].child[b] >= 0) d = max(d, computeDepth(trie[node].child[b]) + 1);
+        }
+        return trie[node].depth = d;
+    }
+
+    // 为前缀树节点node建一张宽为bits的表，返回表的起点
+    uint32_t buildTable(int node, int bits) {
+        uint32_t start = static_cast<uint32_t>(table.size());
+        table.resize(table.size() + (static_cast<size_t>(1) << bits), 0);
+        for (uint32_t pattern = 0; pattern < (1u << bits); ++pattern) {
+            int cur = node, step = 0;
+            while (step < bits && cur >= 0 && trie[cur].symbol < 0) {
+                cur = trie[cur].child[(pattern >> (bits - 1 - step)) & 1];
+                ++step;
+            }
+            uint32_t entry = 0; // 默认为非法编码
+            if (cur >= 0 && trie[cur].symbol >= 0) {
+                entry = (static_cast<uint32_t>(trie[cur].symbol) << 8) | (step << 1);
+            } else if (cur >= 0) {
+                int subBits = min(kSubBits, trie[cur].depth);
+                uint32_t sub = buildTable(cur, subBits);
+                entry = (sub << 8) | (subBits << 1) | 1;
+            }
+            table[start + pattern] = entry;
+        }
+        return start;
+    }
+
 public:
-    HuffTree() : BinTree() {}
+    HuffDecoder() : rootBits(1), symbolsPerRefill(1) {}
 
-    // 构建Huffman树
-    void build(const map<char, int>& freq) {
-        priority_queue<BinTreeNode*, vector<BinTreeNode*>, CompareNodes> pq;
+    // 由每个字符的编码和编码长度建表，长度为0的字符不参与
+    void build(const uint64_t* codeBits, const uint8_t* codeLen, int numSymbols) {
+        trie.clear();
+        table.clear();
+        int rootNode = newTrieNode();
+        for (int sym = 0; sym < numSymbols; ++sym) {
+            int cur = rootNode;
+            for (int i = codeLen[sym] - 1; i >= 0; --i) {
+                int b = static_cast<int>((codeBits[sym] >> i) & 1);
+                if (trie[cur].child[b] < 0) {
+                    int next = newTrieNode();
+                    trie[cur].child[b] = next;
+                }
+                cur = trie[cur].child[b];
+            }
+            if (cur != rootNode) trie[cur].symbol = sym;
+        }
+        int maxLen = computeDepth(rootNode);
+        rootBits = max(1, min(kRootBits, maxLen));
+        symbolsPerRefill = 56 / max(1, maxLen);
+        buildTable(rootNode, rootBits);
+        trie.clear();
+        trie.shrink_to_fit();
+    }
 
-        // 创建叶子节点并加入优先队列
-        for (const auto& pair : freq) {
-            pq.push(new BinTreeNode(pair.first, pair.second));
+    // 不补充输入地解码一个字符，调用方需保证缓冲区中的位数不少于最长编码；遇到非法编码返回-1
+    int decodeBuffered(BitReader& in) const {
+        int width = rootBits;
+        uint32_t entry = table[in.peek(width)];
+        while (entry & 1) {
+            in.consume(width);
+            width = (entry >> 1) & 0x7f;
+            entry = table[(entry >> 8) + in.peek(width)];
         }
+        int len = (entry >> 1) & 0x7f;
+        if (len == 0) return -1;
+        in.consume(len);
+        return static_cast<int>(entry >> 8);
+    }
 
-        // 构建Huffman树
-        while (pq.size() > 1) {
-            BinTreeNode* left = pq.top(); pq.pop();
-            BinTreeNode* right = pq.top(); pq.pop();
+    int decodeSymbol(BitReader& in) const {
+        in.refill();
+        return decodeBuffered(in);
+    }
 
-            BinTreeNode* parent = new BinTreeNode('\0', left->weight + right->weight);
-            parent->left = left;
-            parent->right = right;
+    // 解码count个字符，返回成功解码的个数；每次补充输入后连续解出多个字符
+    size_t decode(BitReader& in, uint8_t* out, size_t count) const {
+        size_t i = 0;
+        while (i < count) {
+            in.refill();
+            size_t batch = min(count - i, static_cast<size_t>(symbolsPerRefill));
+            for (size_t k = 0; k < batch; ++k, ++i) {
+                int sym = decodeBuffered(in);
+                if (sym < 0) return i;
+                out[i] = static_cast<uint8_t>(sym);
+            }
+        }
+        return count;
+    }
+};
 
-            pq.push(parent);
+// 传给min/max时按引用使用，需要类外定义
+const int HuffDecoder::kRootBits;
+const int HuffDecoder::kSubBits;
+
+// 7. 范式Huffman编码
+// 将编码长度限制在maxLen以内：先把超长的叶子截到maxLen，再按Kraft不等式
+// 把最长的较短叶子逐个加长直到编码可行，剩余空间用来缩短高频字符，
+// 最后按频率从高到低依次分配从短到长的长度
+void limitCodeLengths(uint8_t* lengths, const uint64_t* freq, int numSymbols, int maxLen) {
+    int used = 0, longest = 0;
+    for (int i = 0; i < numSymbols; ++i) {
+        if (lengths[i]) {
+            ++used;
+            longest = max(longest, static_cast<int>(lengths[i]));
         }
+    }
+    if (longest <= maxLen) return;
+    while ((1 << maxLen) < used) ++maxLen;
 
-        root = pq.top();
+    vector<long long> count(maxLen + 1, 0);
+    for (int i = 0; i < numSymbols; ++i) {
+        if (lengths[i]) count[min(static_cast<int>(lengths[i]), maxLen)]++;
+    }
+    const long long target = 1LL << maxLen;
+    long long kraft = 0;
+    for (int len = 1; len <= maxLen; ++len) kraft += count[len] << (maxLen - len);
+    while (kraft > target) {
+        int len = maxLen - 1;
+        while (count[len] == 0) --len;
+        count[len]--;
+        count[len + 1]++;
+        kraft -= 1LL << (maxLen - len - 1);
+    }
+    for (int len = 2; len <= maxLen; ++len) {
+        while (count[len] > 0 && kraft + (1LL << (maxLen - len)) <= target) {
+            count[len]--;
+            count[len - 1]++;
+            kraft += 1LL << (maxLen - len);
+        }
+    }
+
+    vector<int> order;
+    for (int i = 0; i < numSymbols; ++i) {
+        if (lengths[i]) order.push_back(i);
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return freq[a] > freq[b]; });
+    size_t k = 0;
+    for (int len = 1; len <= maxLen; ++len) {
+        for (long long c = 0; c < count[len]; ++c) lengths[order[k++]] = static_cast<uint8_t>(len);
+    }
+}
 
-        // 生成Huffman编码
-        generateCodes(root, "");
+// 由编码长度分配范式编码：短编码在前，同样长度的按字符顺序递增
+void assignCanonicalCodes(const uint8_t* lengths, int numSymbols, uint64_t* codes) {
+    int maxLen = 0;
+    for (int i = 0; i < numSymbols; ++i) maxLen = max(maxLen, static_cast<int>(lengths[i]));
+    vector<uint64_t> count(maxLen + 1, 0), nextCode(maxLen + 1, 0);
+    for (int i = 0; i < numSymbols; ++i) {
+        if (lengths[i]) count[lengths[i]]++;
     }
+    uint64_t code = 0;
+    for (int len = 1; len <= maxLen; ++len) {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+    for (int i = 0; i < numSymbols; ++i) {
+        codes[i] = lengths[i] ? nextCode[lengths[i]]++ : 0;
+    }
+}
 
-    // 获取字符的Huffman编码
+// 序列化256个字符的编码长度（每个长度不超过15，占半个字节）：
+// 用到的字符较少时写 [1][字符数][各字符][长度]，否则写 [0][全部256个长度]
+void writeCodeLengths(const uint8_t* lengths, vector<uint8_t>& out) {
+    vector<uint8_t> symbols;
+    for (int i = 0; i < 256; ++i) {
+        if (lengths[i]) symbols.push_back(static_cast<uint8_t>(i));
+    }
+    if (symbols.size() <= 85) {
+        out.push_back(1);
+        out.push_back(static_cast<uint8_t>(symbols.size()));
+        out.insert(out.end(), symbols.begin(), symbols.end());
+        for (size_t i = 0; i < symbols.size(); i += 2) {
+            uint8_t hi = lengths[symbols[i]];
+            uint8_t lo = (i + 1 < symbols.size()) ? lengths[symbols[i + 1]] : 0;
+            out.push_back(static_cast<uint8_t>((hi << 4) | lo));
+        }
+    } else {
+        out.push_back(0);
+        for (int i = 0; i < 256; i += 2) {
+            out.push_back(static_cast<uint8_t>((lengths[i] << 4) | lengths[i + 1]));
+        }
+    }
+}
+
+// 检查编码长度满足Kraft不等式（各字符2^-len之和不超过1），否则不存在这样的前缀码
+bool kraftValid(const uint8_t* lengths, int numSymbols) {
+    uint32_t sum = 0;
+    for (int i = 0; i < numSymbols; ++i) {
+        if (lengths[i]) sum += 1u << (15 - lengths[i]);
+    }
+    return sum <= (1u << 15);
+}
+
+// 从data[pos]开始读取编码长度，成功时pos移到长度表之后；长度表不构成前缀码时返回false
+bool readCodeLengths(const uint8_t* data, size_t size, size_t& pos, uint8_t* lengths) {
+    for (int i = 0; i < 256; ++i) lengths[i] = 0;
+    if (pos >= size) return false;
+    uint8_t mode = data[pos++];
+    if (mode == 0) {
+        if (size - pos < 128) return false;
+        for (int i = 0; i < 256; i += 2) {
+            lengths[i] = data[pos] >> 4;
+            lengths[i + 1] = data[pos] & 0x0f;
+            ++pos;
+        }
+        return kraftValid(lengths, 256);
+    }
+    if (mode != 1 || pos >= size) return false;
+    size_t n = data[pos++];
+    if (size - pos < n + (n + 1) / 2) return false;
+    const uint8_t* symbols = data + pos;
+    const uint8_t* packed = data + pos + n;
+    for (size_t i = 0; i < n; ++i) {
+        lengths[symbols[i]] = (i % 2 == 0) ? (packed[i / 2] >> 4) : (packed[i / 2] & 0x0f);
+    }
+    pos += n + (n + 1) / 2;
+    return kraftValid(lengths, 256);
+}
+
+// 8. Huffman树类：在HuffBuilder的节点数组上求编码长度，再分配范式编码；
+// 编码、解码都查256项的表，朴素解码用的树也按编码建在一个下标数组里，不逐个分配节点
+class HuffTree {
+private:
+    HuffBuilder builder;             // 反复build时复用节点数组
+    uint64_t codeBits[256];          // 码表：每个字节对应的编码，低codeLen位有效
+    uint8_t codeLen[256];            // 编码长度，0表示该字节不输出
+    uint64_t symbolBits[256];        // 每个字符的范式编码，供解码器建表
+    uint8_t symbolLen[256];
+    HuffDecoder decoder;
+    int maxCodeLength;               // 编码长度上限，不超过15
+    // 逐位解码用的树：walk[2k]和walk[2k + 1]是节点k的左右孩子，0表示没有孩子（根不会是孩子），
+    // 负数-1 - c表示字符c的叶子
+    vector<int> walk;
+
+    // 建立256项的码表，与encode的行为一致：大写字母使用小写字母的编码，非字母不输出
+    void buildCodeTable() {
+        for (int c = 0; c < 256; ++c) {
+            int lower = isalpha(c) ? tolower(c) : -1;
+            codeBits[c] = (lower >= 0) ? symbolBits[lower] : 0;
+            codeLen[c] = (lower >= 0) ? symbolLen[lower] : 0;
+        }
+    }
+
+    // 按各字符的编码逐位插入，得到与编码一致的树
+    void buildWalkTree() {
+        walk.assign(2, 0);
+        walk.reserve(2 * 256);
+        for (int c = 0; c < 256; ++c) {
+            if (symbolLen[c] == 0) continue;
+            int node = 0;
+            for (int i = symbolLen[c] - 1; i > 0; --i) {
+                size_t slot = 2 * node + ((symbolBits[c] >> i) & 1);
+                if (walk[slot] == 0) {
+                    walk[slot] = static_cast<int>(walk.size() / 2);
+                    walk.resize(walk.size() + 2, 0);
+                }
+                node = walk[slot];
+            }
+            walk[2 * node + (symbolBits[c] & 1)] = -1 - c;
+        }
+    }
+
+public:
+    HuffTree() : maxCodeLength(15) {
+        for (int c = 0; c < 256; ++c) {
+            codeBits[c] = 0;
+            codeLen[c] = 0;
+            symbolBits[c] = 0;
+            symbolLen[c] = 0;
+        }
+    }
+
+    // 设置编码长度上限（8到15之间），在build之前调用
+    void setMaxCodeLength(int len) { maxCodeLength = max(8, min(15, len)); }
+
+    // 构建Huffman编码
+    void build(const map<char, int>& freq) {
+        uint64_t weights[256] = {};
+        for (const auto& pair : freq) weights[static_cast<unsigned char>(pair.first)] = pair.second;
+        uint8_t lengths[256];
+        builder.computeLengths(weights, 256, lengths);
+        limitCodeLengths(lengths, weights, 256, maxCodeLength);
+        buildFromLengths(lengths);
+    }
+
+    // 只根据编码长度重建：分配范式编码，再建码表、解码表和逐位解码用的树
+    void buildFromLengths(const uint8_t* lengths) {
+        for (int c = 0; c < 256; ++c) symbolLen[c] = lengths[c];
+        assignCanonicalCodes(symbolLen, 256, symbolBits);
+        buildCodeTable();
+        buildWalkTree();
+        decoder.build(symbolBits, symbolLen, 256);
+    }
+
+    // 序列化编码长度表作为压缩数据的头部
+    void writeHeader(vector<uint8_t>& out) const { writeCodeLengths(symbolLen, out); }
+
+    // 从头部恢复编码，成功时pos移到头部之后
+    bool readHeader(const uint8_t* data, size_t size, size_t& pos) {
+        uint8_t lengths[256];
+        if (!readCodeLengths(data, size, pos, lengths)) return false;
+        buildFromLengths(lengths);
+        return true;
+    }
+
+    const uint8_t* codeLengths() const { return symbolLen; }
+
+    // 编码时字节b使用的编码，长度为0表示不输出
+    uint64_t codeBitsOf(unsigned char b) const { return codeBits[b]; }
+    int codeLengthOf(unsigned char b) const { return codeLen[b]; }
+
+    // 获取字符的Huffman编码，按码表生成0/1字符串
     string getCode(char c) const {
-        auto it = huffmanCodes.find(tolower(c));
-        return (it != huffmanCodes.end()) ? it->second : "";
+        unsigned char lower = static_cast<unsigned char>(tolower(static_cast<unsigned char>(c)));
+        string code(symbolLen[lower], '0');
+        for (int i = 0; i < symbolLen[lower]; ++i) {
+            if ((symbolBits[lower] >> (symbolLen[lower] - 1 - i)) & 1) code[i] = '1';
+        }
+        return code;
     }
 
     // 编码字符串
@@ -119,45 +601,200 @@ public:
         return encoded;
     }
 
+    // 查表编码，直接写入位缓冲区
+    void encodeBits(const string& text, BitWriter& out) const {
+        for (char c : text) {
+            unsigned char b = static_cast<unsigned char>(c);
+            out.write(codeBits[b], codeLen[b]);
+        }
+    }
+
+    // 查表解码count个字符
+    string decodeBits(const vector<uint8_t>& bytes, size_t count) const {
+        string text(count, '\0');
+        BitReader in(bytes.data(), bytes.size());
+        size_t n = decoder.decode(in, reinterpret_cast<uint8_t*>(&text[0]), count);
+        text.resize(n);
+        return text;
+    }
+
+    // 沿树逐位走到叶子的朴素解码，用于对比
+    string decodeTreeWalk(const vector<uint8_t>& bytes, size_t count) const {
+        string text;
+        if (walk.empty()) return text;
+        size_t bit = 0, totalBits = bytes.size() * 8;
+        while (text.size() < count && bit < totalBits) {
+            int node = 0;
+            while (node >= 0 && bit < totalBits) {
+                int b = (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+                ++bit;
+                node = walk[2 * node + b];
+                if (node == 0) return text; // 没有这个编码
+            }
+            if (node >= 0) break;
+            text += static_cast<char>(-1 - node);
+        }
+        return text;
+    }
+
     // 打印所有字符的Huffman编码
     void printCodes() const {
-        for (const auto& pair : huffmanCodes) {
-            cout << pair.first << ": " << pair.second << endl;
+        for (int c = 0; c < 256; ++c) {
+            if (symbolLen[c]) cout << static_cast<char>(c) << ": " << getCode(static_cast<char>(c)) << endl;
         }
     }
 };
 
-// 5. 位图类（用于存储二进制编码）
+// 统计64位字中1的个数
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// 9. 位图类（用于存储二进制编码）
+// 按64位字存储，第i位位于第i/64个字中从高位数起的第i%64位，与编码的书写顺序一致，
+// 因此一段编码可以整字追加；最后一个字中超出size()的位始终为0
 class Bitmap {
 private:
-    vector<bool> bits;
+    vector<uint64_t> words;
+    size_t nbits;
+    mutable vector<size_t> rankDir;   // rankDir[w]为前w个字中1的个数，修改后失效
+    mutable bool rankValid;
+
+    void buildRank() const {
+        rankDir.assign(words.size() + 1, 0);
+        for (size_t w = 0; w < words.size(); ++w) rankDir[w + 1] = rankDir[w] + popcount64(words[w]);
+        rankValid = true;
+    }
+
+    void resizeBits(size_t n) {
+        words.resize((n + 63) / 64, 0);
+        nbits = n;
+        if (n & 63) words.back() &= ~0ULL << (64 - (n & 63));
+        rankValid = false;
+    }
 
 public:
-    Bitmap() {}
+    Bitmap() : nbits(0), rankValid(false) {}
+    explicit Bitmap(size_t n) : words((n + 63) / 64, 0), nbits(n), rankValid(false) {}
+
+    size_t size() const { return nbits; }
+    const vector<uint64_t>& data() const { return words; }
 
     // 添加一个二进制位
     void append(bool bit) {
-        bits.push_back(bit);
+        appendBits(bit ? 1 : 0, 1);
     }
 
-    // 从字符串添加二进制位
+    // 添加value的低n位（n不超过64），高位在前
+    void appendBits(uint64_t value, int n) {
+        if (n <= 0) return;
+        if (n < 64) value &= (1ULL << n) - 1;
+        int offset = static_cast<int>(nbits & 63);
+        if (offset == 0) words.push_back(0);
+        int room = 64 - offset;
+        if (n <= room) {
+            words.back() |= value << (room - n);
+        } else {
+            words.back() |= value >> (n - room);
+            words.push_back(value << (64 - (n - room)));
+        }
+        nbits += n;
+        rankValid = false;
+    }
+
+    // 从字符串添加二进制位，每64个字符合成一个字再追加
     void appendBits(const string& bitStr) {
-        for (char c : bitStr) {
-            append(c == '1');
+        for (size_t i = 0; i < bitStr.size(); i += 64) {
+            size_t n = min<size_t>(64, bitStr.size() - i);
+            uint64_t value = 0;
+            for (size_t j = 0; j < n; ++j) value = (value << 1) | (bitStr[i + j] == '1');
+            appendBits(value, static_cast<int>(n));
+        }
+    }
+
+    bool test(size_t i) const { return (words[i >> 6] >> (63 - (i & 63))) & 1; }
+    bool get(size_t i) const { return test(i); }
+
+    void set(size_t i, bool bit = true) {
+        uint64_t mask = 1ULL << (63 - (i & 63));
+        if (bit) words[i >> 6] |= mask;
+        else words[i >> 6] &= ~mask;
+        rankValid = false;
+    }
+
+    size_t popcount() const {
+        size_t total = 0;
+        for (uint64_t w : words) total += popcount64(w);
+        return total;
+    }
+
+    // [0, i)中1的个数
+    size_t rank(size_t i) const {
+        if (!rankValid) buildRank();
+        size_t w = i >> 6;
+        int r = static_cast<int>(i & 63);
+        return rankDir[w] + (r ? popcount64(words[w] >> (64 - r)) : 0);
+    }
+
+    // 第k个1（从0开始计数）的位置，不存在时返回size()
+    size_t select(size_t k) const {
+        if (!rankValid) buildRank();
+        if (k >= rankDir.back()) return nbits;
+        // 找到包含第k个1的字，再在字内按二分逐段缩小
+        size_t w = upper_bound(rankDir.begin(), rankDir.end(), k) - rankDir.begin() - 1;
+        size_t j = k - rankDir[w];
+        uint64_t x = words[w];
+        int pos = 0;
+        for (int width = 32; width > 0; width /= 2) {
+            size_t c = popcount64(x >> (64 - width));
+            if (j >= c) {
+                j -= c;
+                x <<= width;
+                pos += width;
+            }
         }
+        return w * 64 + pos;
+    }
+
+    // 按字的批量运算：与运算保持自身长度，或和异或运算扩展到较长的一方
+    Bitmap& operator&=(const Bitmap& other) {
+        for (size_t w = 0; w < words.size(); ++w) words[w] &= (w < other.words.size()) ? other.words[w] : 0;
+        rankValid = false;
+        return *this;
+    }
+
+    Bitmap& operator|=(const Bitmap& other) {
+        if (other.nbits > nbits) resizeBits(other.nbits);
+        for (size_t w = 0; w < other.words.size(); ++w) words[w] |= other.words[w];
+        rankValid = false;
+        return *this;
+    }
+
+    Bitmap& operator^=(const Bitmap& other) {
+        if (other.nbits > nbits) resizeBits(other.nbits);
+        for (size_t w = 0; w < other.words.size(); ++w) words[w] ^= other.words[w];
+        rankValid = false;
+        return *this;
     }
 
     // 获取位图的字符串表示
     string toString() const {
-        string result;
-        for (bool bit : bits) {
-            result += (bit ? '1' : '0');
+        string result(nbits, '0');
+        for (size_t i = 0; i < nbits; ++i) {
+            if (test(i)) result[i] = '1';
         }
         return result;
     }
 };
 
-// 6. Huffman编码串类
+// 10. Huffman编码串类
 class HuffCode {
 private:
     Bitmap code;
@@ -170,14 +807,888 @@ public:
         code.appendBits(huffmanCode);
     }
 
+    // 按整段编码追加，bits的低len位有效
+    void append(uint64_t bits, int len) {
+        code.appendBits(bits, len);
+    }
+
+    // 用tree的码表编码text并追加
+    void append(const HuffTree& tree, const string& text) {
+        for (char c : text) {
+            unsigned char b = static_cast<unsigned char>(c);
+            code.appendBits(tree.codeBitsOf(b), tree.codeLengthOf(b));
+        }
+    }
+
+    const Bitmap& bits() const { return code; }
+    size_t size() const { return code.size(); }
+
     // 获取编码的字符串表示
     string toString() const {
         return code.toString();
     }
 };
 
-// 主函数，用于测试
-int main() {
+// 11. 任意字节流的分块Huffman压缩
+// 文件格式：["HUF1"][块大小 u32] 若干块 [0xFF] [块索引]，整数均为小端序；
+// 每块为 [类型 u8][原始长度 u32][负载长度 u32][负载]，
+// 类型0的负载是原始数据，类型1的负载是编码长度表加编码数据；
+// 块索引为每块的 [记录位置 u64][原始长度 u32][记录长度 u32]，
+// 文件最后16字节为 [块数 u32][索引位置 u64]["HIDX"]，顺序解压时读到0xFF即停止
+const uint8_t kBlockStored = 0;
+const uint8_t kBlockHuffman = 1;
+const uint8_t kBlockEnd = 0xFF;
+const size_t kDefaultBlockSize = 256 * 1024;
+
+void putU32(vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void putU64(vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint64_t getU64(const uint8_t* p) {
+    return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+}
+
+// 统计字节频率：四张计数表交错累加，连续出现的相同字节落在不同的计数器上，
+// 避免对同一地址的读改写互相等待（存储转发停顿）
+void countFrequencies(const uint8_t* data, size_t n, uint64_t* freq) {
+    for (int c = 0; c < 256; ++c) freq[c] = 0;
+    uint32_t counts[4][256];
+    const size_t chunk = 1u << 30; // 每段不超过2^30字节，32位计数器不会溢出
+    for (size_t base = 0; base < n; base += chunk) {
+        memset(counts, 0, sizeof(counts));
+        const uint8_t* p = data + base;
+        size_t len = min(chunk, n - base), i = 0;
+        for (; i + 4 <= len; i += 4) {
+            counts[0][p[i]]++;
+            counts[1][p[i + 1]]++;
+            counts[2][p[i + 2]]++;
+            counts[3][p[i + 3]]++;
+        }
+        for (; i < len; ++i) counts[0][p[i]]++;
+        for (int c = 0; c < 256; ++c) freq[c] += counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+    }
+}
+
+// 压缩一个块并追加到out；编码后不比原始数据小时直接存储
+void compressBlock(const uint8_t* data, size_t n, HuffBuilder& builder, vector<uint8_t>& out) {
+    uint64_t freq[256];
+    uint8_t lengths[256];
+    uint64_t codes[256];
+    countFrequencies(data, n, freq);
+    builder.computeLengths(freq, 256, lengths);
+    limitCodeLengths(lengths, freq, 256, 15);
+    assignCanonicalCodes(lengths, 256, codes);
+
+    vector<uint8_t> header;
+    writeCodeLengths(lengths, header);
+    uint64_t bits = 0;
+    for (int c = 0; c < 256; ++c) bits += freq[c] * lengths[c];
+    size_t payload = header.size() + static_cast<size_t>((bits + 7) / 8);
+
+    if (n == 0 || payload >= n) {
+        out.push_back(kBlockStored);
+        putU32(out, static_cast<uint32_t>(n));
+        putU32(out, static_cast<uint32_t>(n));
+        out.insert(out.end(), data, data + n);
+        return;
+    }
+    BitWriter writer;
+    writer.reserve(payload);
+    for (size_t i = 0; i < n; ++i) writer.write(codes[data[i]], lengths[data[i]]);
+    writer.finish();
+    out.push_back(kBlockHuffman);
+    putU32(out, static_cast<uint32_t>(n));
+    putU32(out, static_cast<uint32_t>(payload));
+    out.insert(out.end(), header.begin(), header.end());
+    out.insert(out.end(), writer.data().begin(), writer.data().end());
+}
+
+// 解压一个块的负载，结果追加到out
+bool decompressBlock(uint8_t type, const uint8_t* payload, size_t size, size_t rawSize,
+                     HuffDecoder& decoder, vector<uint8_t>& out) {
+    if (type == kBlockStored) {
+        if (size != rawSize) return false;
+        out.insert(out.end(), payload, payload + size);
+        return true;
+    }
+    if (type != kBlockHuffman) return false;
+    uint8_t lengths[256];
+    uint64_t codes[256];
+    size_t pos = 0;
+    if (!readCodeLengths(payload, size, pos, lengths)) return false;
+    for (int c = 0; c < 256; ++c) {
+        if (lengths[c] > 15) return false;
+    }
+    // 每个字符至少1位，原始长度不会超过负载位数；先核对再按头部中的长度分配
+    if (rawSize > 8 * (size - pos)) return false;
+    assignCanonicalCodes(lengths, 256, codes);
+    decoder.build(codes, lengths, 256);
+    size_t start = out.size();
+    out.resize(start + rawSize);
+    BitReader in(payload + pos, size - pos);
+    return decoder.decode(in, out.data() + start, rawSize) == rawSize;
+}
+
+// 块索引：每块记录在文件中的位置、原始长度和记录长度
+struct BlockIndex {
+    vector<uint64_t> offset;
+    vector<uint32_t> rawSize;
+    vector<uint32_t> recordSize;
+    vector<uint64_t> rawOffset;   // 块解压后在原始数据中的位置
+};
+
+// 流式压缩：feed逐段送入数据，finish写出剩余数据和块索引。
+// 攒够一批块（线程数的两倍）后在线程池上并行压缩并按顺序写出；
+// 调用方送入的整块数据直接引用、不做拷贝，只有不足一块的零头才拷贝到内部缓冲区，
+// 因此除块索引外，内存占用只与块大小和线程数有关，与输入总长度无关
+class HuffStreamEncoder {
+private:
+    ostream& out;
+    size_t blockSize;
+    ThreadPool pool;
+    vector<HuffBuilder> builders;
+    size_t batch;
+    vector<const uint8_t*> pendingData;   // 本批待压缩的块
+    vector<size_t> pendingSize;
+    bool borrowed;                        // 本批是否引用了调用方的内存
+    vector<vector<uint8_t>> owned;        // 拷贝下来的块，与本批的位置一一对应
+    vector<uint8_t> partial;              // 不足一块的零头
+    vector<vector<uint8_t>> packed;
+    vector<uint8_t> index;
+    uint64_t written;
+    uint32_t blockCount;
+
+    void addBlock(const uint8_t* data, size_t size) {
+        pendingData.push_back(data);
+        pendingSize.push_back(size);
+        if (pendingData.size() == batch) flushBatch();
+    }
+
+    void flushBatch() {
+        size_t n = pendingData.size();
+        pool.parallelFor(n, [&](size_t i, int id) {
+            packed[i].clear();
+            compressBlock(pendingData[i], pendingSize[i], builders[id], packed[i]);
+        });
+        for (size_t i = 0; i < n; ++i) {
+            putU64(index, written);
+            putU32(index, static_cast<uint32_t>(pendingSize[i]));
+            putU32(index, static_cast<uint32_t>(packed[i].size()));
+            out.write(reinterpret_cast<const char*>(packed[i].data()), packed[i].size());
+            written += packed[i].size();
+            ++blockCount;
+        }
+        pendingData.clear();
+        pendingSize.clear();
+        borrowed = false;
+    }
+
+    // 零头攒满一块后交给本批，换一个空缓冲区继续攒
+    void commitPartial() {
+        size_t slot = pendingData.size();
+        owned[slot].swap(partial);
+        partial.clear();
+        addBlock(owned[slot].data(), owned[slot].size());
+    }
+
+public:
+    HuffStreamEncoder(ostream& output, size_t blockBytes = kDefaultBlockSize, int threads = defaultThreads())
+        : out(output), blockSize(blockBytes), pool(threads), builders(pool.size()),
+          batch(2 * pool.size()), borrowed(false), owned(batch), packed(batch),
+          written(0), blockCount(0) {
+        vector<uint8_t> header = { 'H', 'U', 'F', '1' };
+        putU32(header, static_cast<uint32_t>(blockSize));
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+        written = header.size();
+        partial.reserve(blockSize);
+    }
+
+    bool feed(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            if (!partial.empty() || size < blockSize) {
+                size_t take = min(blockSize - partial.size(), size);
+                partial.insert(partial.end(), data, data + take);
+                data += take;
+                size -= take;
+                if (partial.size() == blockSize) commitPartial();
+            } else {
+                borrowed = true;
+                addBlock(data, blockSize);
+                data += blockSize;
+                size -= blockSize;
+            }
+        }
+        // 返回后调用方的内存可能失效，引用了它的块必须在此之前压缩完
+        if (borrowed) flushBatch();
+        return static_cast<bool>(out);
+    }
+
+    bool finish() {
+        if (!partial.empty()) commitPartial();
+        if (!pendingData.empty()) flushBatch();
+        index.insert(index.begin(), kBlockEnd);
+        putU32(index, blockCount);
+        putU64(index, written + 1);
+        index.insert(index.end(), { 'H', 'I', 'D', 'X' });
+        out.write(reinterpret_cast<const char*>(index.data()), index.size());
+        index.clear();
+        out.flush();
+        return static_cast<bool>(out);
+    }
+};
+
+// 从输入流压缩：每次读入一批块大小的数据送给流式压缩器
+bool compressStream(istream& in, ostream& out, size_t blockSize = kDefaultBlockSize,
+                    int threads = defaultThreads()) {
+    HuffStreamEncoder encoder(out, blockSize, threads);
+    vector<uint8_t> buffer(blockSize * 2 * max(1, threads));
+    while (in) {
+        in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        size_t n = static_cast<size_t>(in.gcount());
+        if (n > 0 && !encoder.feed(buffer.data(), n)) return false;
+    }
+    return encoder.finish();
+}
+
+// 压缩文件：优先用内存映射直接把整个文件交给流式压缩器，映射失败时按流读取
+bool compressFile(const string& path, ostream& out, size_t blockSize = kDefaultBlockSize,
+                  int threads = defaultThreads()) {
+    MappedFile file;
+    if (file.open(path)) {
+        HuffStreamEncoder encoder(out, blockSize, threads);
+        return encoder.feed(file.data(), file.size()) && encoder.finish();
+    }
+    ifstream in(path, ios::binary);
+    return in && compressStream(in, out, blockSize, threads);
+}
+
+// 从文件末尾读取块索引，没有索引时返回false。
+// 有索引时逐项核对：各块记录从文件头之后开始首尾相接，最后一块之后紧跟结束标记和索引，
+// 每条记录至少有9字节的记录头，原始长度不超过文件头中的块大小；不符时抛出runtime_error，
+// 否则损坏的索引会让并行解压按错误的位置和长度读取、分配缓冲区
+bool readBlockIndex(istream& in, BlockIndex& index) {
+    in.clear();
+    in.seekg(0, ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    const uint64_t headerEnd = 8;
+    if (fileSize < headerEnd + 1 + 16) return false;
+    uint8_t header[8], trailer[16];
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(header), 8) || memcmp(header, "HUF1", 4) != 0) return false;
+    in.seekg(fileSize - 16);
+    if (!in.read(reinterpret_cast<char*>(trailer), 16) || memcmp(trailer + 12, "HIDX", 4) != 0) return false;
+    uint32_t blockSize = getU32(header + 4);
+    uint32_t count = getU32(trailer);
+    uint64_t indexPos = getU64(trailer + 4);
+    uint64_t indexBytes = static_cast<uint64_t>(count) * 16;
+    if (indexBytes > fileSize - 16 - headerEnd - 1 || indexPos != fileSize - 16 - indexBytes) {
+        throw runtime_error("block index does not match the file size");
+    }
+    vector<uint8_t> raw(static_cast<size_t>(indexBytes));
+    in.seekg(indexPos);
+    if (count > 0 && !in.read(reinterpret_cast<char*>(raw.data()), raw.size())) return false;
+    index = BlockIndex();
+    uint64_t rawPos = 0, recordPos = headerEnd;
+    const uint64_t recordsEnd = indexPos - 1; // 结束标记的位置
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t offset = getU64(&raw[i * 16]);
+        uint32_t rawSize = getU32(&raw[i * 16 + 8]);
+        uint32_t recordSize = getU32(&raw[i * 16 + 12]);
+        if (offset != recordPos || recordSize < 9 || recordSize > recordsEnd - offset || rawSize > blockSize) {
+            throw runtime_error("corrupt block index entry " + to_string(i));
+        }
+        index.offset.push_back(offset);
+        index.rawSize.push_back(rawSize);
+        index.recordSize.push_back(recordSize);
+        index.rawOffset.push_back(rawPos);
+        rawPos += rawSize;
+        recordPos = offset + recordSize;
+    }
+    if (recordPos != recordsEnd) throw runtime_error("block index does not cover all blocks");
+    return true;
+}
+
+// 解析一条块记录 [类型][原始长度][负载长度][负载] 并解压
+bool decompressRecord(const uint8_t* record, size_t size, HuffDecoder& decoder, vector<uint8_t>& out) {
+    if (size < 9) return false;
+    size_t rawSize = getU32(record + 1), payloadSize = getU32(record + 5);
+    if (payloadSize != size - 9) return false;
+    return decompressBlock(record[0], record + 9, payloadSize, rawSize, decoder, out);
+}
+
+// 随机访问：只读取并解压第i块
+bool readBlock(istream& in, const BlockIndex& index, size_t i, vector<uint8_t>& out) {
+    if (i >= index.offset.size()) return false;
+    vector<uint8_t> record(index.recordSize[i]);
+    in.clear();
+    in.seekg(index.offset[i]);
+    if (!in.read(reinterpret_cast<char*>(record.data()), record.size())) return false;
+    HuffDecoder decoder;
+    out.clear();
+    return decompressRecord(record.data(), record.size(), decoder, out);
+}
+
+// 按索引每次读入一批连续的块记录，在线程池上并行解压后按顺序写出
+bool decompressIndexed(istream& in, const BlockIndex& index, ostream& out, int threads = defaultThreads()) {
+    ThreadPool pool(threads);
+    vector<HuffDecoder> decoders(pool.size());
+    size_t batch = 2 * pool.size();
+    vector<vector<uint8_t>> raw(batch);
+    vector<uint8_t> records;
+    size_t count = index.offset.size();
+    for (size_t first = 0; first < count; first += batch) {
+        size_t n = min(batch, count - first);
+        uint64_t begin = index.offset[first];
+        uint64_t end = index.offset[first + n - 1] + index.recordSize[first + n - 1];
+        records.resize(static_cast<size_t>(end - begin));
+        in.clear();
+        in.seekg(begin);
+        if (!in.read(reinterpret_cast<char*>(records.data()), records.size())) return false;
+        atomic<bool> ok(true);
+        pool.parallelFor(n, [&](size_t i, int id) {
+            raw[i].clear();
+            size_t b = first + i;
+            const uint8_t* record = records.data() + (index.offset[b] - begin);
+            if (!decompressRecord(record, index.recordSize[b], decoders[id], raw[i])) ok = false;
+        });
+        if (!ok) return false;
+        for (size_t i = 0; i < n; ++i) out.write(reinterpret_cast<const char*>(raw[i].data()), raw[i].size());
+    }
+    return static_cast<bool>(out);
+}
+
+bool decompressStream(istream& in, ostream& out) {
+    uint8_t header[8];
+    if (!in.read(reinterpret_cast<char*>(header), 8) || memcmp(header, "HUF1", 4) != 0) return false;
+    size_t blockSize = getU32(header + 4);
+
+    HuffDecoder decoder;
+    vector<uint8_t> payload, raw;
+    while (true) {
+        uint8_t blockHeader[9];
+        if (!in.read(reinterpret_cast<char*>(blockHeader), 1)) return false;
+        if (blockHeader[0] == kBlockEnd) break;
+        if (!in.read(reinterpret_cast<char*>(blockHeader + 1), 8)) return false;
+        size_t rawSize = getU32(blockHeader + 1), size = getU32(blockHeader + 5);
+        // 负载不比原始数据长，原始数据不超过块大小；先核对，避免按损坏的长度分配缓冲区
+        if (rawSize > blockSize || size > blockSize) return false;
+        payload.resize(size);
+        if (!in.read(reinterpret_cast<char*>(payload.data()), size)) return false;
+        raw.clear();
+        if (!decompressBlock(blockHeader[0], payload.data(), size, rawSize, decoder, raw)) return false;
+        out.write(reinterpret_cast<const char*>(raw.data()), raw.size());
+    }
+    return static_cast<bool>(out);
+}
+
+// 12. 自适应Huffman编码：编码器和解码器各自统计已处理字符的次数，
+// 在相同的位置按相同的计数重建范式编码，因此只需扫描一遍，也不必传输码表；
+// 字母表在256个字节之外多一个结束符，计数都从1开始，任何字符随时都有编码
+const int kAdaptiveSymbols = 257;
+const int kAdaptiveEnd = 256;
+const size_t kDefaultRebuildInterval = 4096;
+
+class AdaptiveModel {
+private:
+    uint64_t freq[kAdaptiveSymbols];
+    uint64_t total;
+    size_t interval;       // 两次重建之间的最大字符数
+    size_t step;           // 当前的重建间隔，从256开始倍增到interval，使开头也能较快适应
+    size_t sinceRebuild;
+    HuffBuilder builder;
+
+    void rebuild() {
+        // 计数过大时减半，让较早的统计逐渐失去影响，跟上数据分布的变化
+        if (total > max<uint64_t>(static_cast<uint64_t>(interval) << 6, 1 << 16)) {
+            total = 0;
+            for (int c = 0; c < kAdaptiveSymbols; ++c) total += freq[c] = (freq[c] + 1) / 2;
+        }
+        builder.computeLengths(freq, kAdaptiveSymbols, lengths);
+        limitCodeLengths(lengths, freq, kAdaptiveSymbols, 15);
+        assignCanonicalCodes(lengths, kAdaptiveSymbols, codes);
+    }
+
+public:
+    uint64_t codes[kAdaptiveSymbols];
+    uint8_t lengths[kAdaptiveSymbols];
+
+    explicit AdaptiveModel(size_t rebuildInterval = kDefaultRebuildInterval)
+        : total(kAdaptiveSymbols), interval(max<size_t>(rebuildInterval, 1)),
+          step(min<size_t>(256, interval)), sinceRebuild(0) {
+        for (int c = 0; c < kAdaptiveSymbols; ++c) freq[c] = 1;
+        rebuild();
+    }
+
+    // 记录一个已编码（或已解码）的字符，编码发生变化时返回true
+    bool update(int sym) {
+        ++freq[sym];
+        ++total;
+        if (++sinceRebuild < step) return false;
+        sinceRebuild = 0;
+        step = min(step * 2, interval);
+        rebuild();
+        return true;
+    }
+
+    size_t rebuildInterval() const { return interval; }
+};
+
+// 自适应编码器：put之后随时可以用drain取走已经凑满的字节，延迟不超过一个字符的编码
+class AdaptiveHuffEncoder {
+private:
+    AdaptiveModel model;
+    BitWriter writer;
+
+public:
+    explicit AdaptiveHuffEncoder(size_t rebuildInterval = kDefaultRebuildInterval) : model(rebuildInterval) {}
+
+    void put(const uint8_t* data, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            writer.write(model.codes[data[i]], model.lengths[data[i]]);
+            model.update(data[i]);
+        }
+    }
+
+    void drain(vector<uint8_t>& out) { writer.drain(out); }
+
+    // 写出结束符并补齐最后一个字节
+    void finish(vector<uint8_t>& out) {
+        writer.write(model.codes[kAdaptiveEnd], model.lengths[kAdaptiveEnd]);
+        writer.finish();
+        writer.drain(out);
+    }
+};
+
+// 自适应解码器：输入可以分段送入，缓冲区中的位不少于最长编码时才解码，
+// 因此每段解出的字符不依赖后续输入如何切分
+class AdaptiveHuffDecoder {
+private:
+    AdaptiveModel model;
+    HuffDecoder decoder;
+    vector<uint8_t> pending;   // 尚未完全解码的输入
+    size_t bitPos;             // pending中已经消耗的位数
+    bool done;
+
+    bool decodeAvailable(vector<uint8_t>& out, bool final) {
+        size_t totalBits = pending.size() * 8;
+        BitReader in(pending.data() + bitPos / 8, pending.size() - bitPos / 8);
+        in.refill();
+        in.consume(static_cast<int>(bitPos % 8));
+        while (!done && (final || totalBits - bitPos >= 15)) {
+            int sym = decoder.decodeSymbol(in);
+            if (sym < 0) return false;
+            bitPos += model.lengths[sym];
+            if (bitPos > totalBits) return false;   // 用到了末尾补的0
+            if (sym == kAdaptiveEnd) {
+                done = true;
+                break;
+            }
+            out.push_back(static_cast<uint8_t>(sym));
+            if (model.update(sym)) decoder.build(model.codes, model.lengths, kAdaptiveSymbols);
+        }
+        pending.erase(pending.begin(), pending.begin() + bitPos / 8);
+        bitPos %= 8;
+        return true;
+    }
+
+public:
+    explicit AdaptiveHuffDecoder(size_t rebuildInterval = kDefaultRebuildInterval)
+        : model(rebuildInterval), bitPos(0), done(false) {
+        decoder.build(model.codes, model.lengths, kAdaptiveSymbols);
+    }
+
+    // 送入一段输入，解出的字符追加到out；遇到非法编码返回false
+    bool feed(const uint8_t* data, size_t n, vector<uint8_t>& out) {
+        if (done) return true;
+        pending.insert(pending.end(), data, data + n);
+        return decodeAvailable(out, false);
+    }
+
+    // 输入结束：解完剩余的位，必须正好遇到结束符
+    bool finish(vector<uint8_t>& out) {
+        if (!done && !decodeAvailable(out, true)) return false;
+        return done;
+    }
+
+    bool finished() const { return done; }
+};
+
+// 单遍流式压缩：["HUFA"][重建间隔 u32] 之后是自适应编码的位流，边读边写
+bool adaptiveCompressStream(istream& in, ostream& out, size_t rebuildInterval = kDefaultRebuildInterval) {
+    vector<uint8_t> header = { 'H', 'U', 'F', 'A' };
+    putU32(header, static_cast<uint32_t>(rebuildInterval));
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    AdaptiveHuffEncoder encoder(rebuildInterval);
+    vector<uint8_t> buffer(64 * 1024), packed;
+    while (in) {
+        in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        size_t n = static_cast<size_t>(in.gcount());
+        encoder.put(buffer.data(), n);
+        packed.clear();
+        encoder.drain(packed);
+        out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    packed.clear();
+    encoder.finish(packed);
+    out.write(reinterpret_cast<const char*>(packed.data()), packed.size());
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+bool adaptiveDecompressStream(istream& in, ostream& out) {
+    uint8_t header[8];
+    if (!in.read(reinterpret_cast<char*>(header), 8) || memcmp(header, "HUFA", 4) != 0) return false;
+    AdaptiveHuffDecoder decoder(getU32(header + 4));
+    vector<uint8_t> buffer(64 * 1024), raw;
+    while (in && !decoder.finished()) {
+        in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        raw.clear();
+        if (!decoder.feed(buffer.data(), static_cast<size_t>(in.gcount()), raw)) return false;
+        out.write(reinterpret_cast<const char*>(raw.data()), raw.size());
+    }
+    raw.clear();
+    if (!decoder.finish(raw)) return false;
+    out.write(reinterpret_cast<const char*>(raw.data()), raw.size());
+    return static_cast<bool>(out);
+}
+
+// 命令行工具：
+//   compress <输入> <输出> [块大小KB] [线程数]
+//   decompress <输入> <输出> [线程数]      有块索引时并行解压，否则顺序解压
+//   extract <输入> <输出> <块号>           只解压一块
+//   acompress <输入> <输出> [重建间隔]     单遍自适应压缩
+//   adecompress <输入> <输出>
+int runTool(int argc, char* argv[]) {
+    string command = argv[1];
+    bool known = command == "compress" || command == "decompress" || command == "extract" ||
+                 command == "acompress" || command == "adecompress";
+    if (!known || argc < 4 || (command == "extract" && argc < 5)) {
+        cerr << "usage: " << argv[0] << " compress <input> <output> [blockKB] [threads]" << endl;
+        cerr << "       " << argv[0] << " decompress <input> <output> [threads]" << endl;
+        cerr << "       " << argv[0] << " extract <input> <output> <block>" << endl;
+        cerr << "       " << argv[0] << " acompress <input> <output> [rebuildInterval]" << endl;
+        cerr << "       " << argv[0] << " adecompress <input> <output>" << endl;
+        return 2;
+    }
+    ifstream in(argv[2], ios::binary);
+    ofstream out(argv[3], ios::binary);
+    if (!in || !out) {
+        cerr << "cannot open " << (!in ? argv[2] : argv[3]) << endl;
+        return 1;
+    }
+    bool ok;
+    if (command == "compress") {
+        size_t blockSize = (argc > 4) ? static_cast<size_t>(stoul(argv[4])) * 1024 : kDefaultBlockSize;
+        int threads = (argc > 5) ? stoi(argv[5]) : defaultThreads();
+        in.close();
+        ok = compressFile(argv[2], out, max<size_t>(blockSize, 1024), threads);
+    } else if (command == "acompress") {
+        size_t interval = (argc > 4) ? static_cast<size_t>(stoul(argv[4])) : kDefaultRebuildInterval;
+        ok = adaptiveCompressStream(in, out, max<size_t>(interval, 1));
+    } else if (command == "adecompress") {
+        ok = adaptiveDecompressStream(in, out);
+    } else {
+        BlockIndex index;
+        bool indexed;
+        try {
+            indexed = readBlockIndex(in, index);
+        } catch (const runtime_error& e) {
+            cerr << command << " failed: " << e.what() << endl;
+            return 1;
+        }
+        if (command == "extract") {
+            vector<uint8_t> block;
+            ok = indexed && readBlock(in, index, static_cast<size_t>(stoul(argv[4])), block);
+            out.write(reinterpret_cast<const char*>(block.data()), block.size());
+        } else if (indexed) {
+            ok = decompressIndexed(in, index, out, (argc > 4) ? stoi(argv[4]) : defaultThreads());
+        } else {
+            in.clear();
+            in.seekg(0);
+            ok = decompressStream(in, out);
+        }
+    }
+    if (!ok) {
+        bool compressing = command == "compress" || command == "acompress";
+        cerr << command << " failed: " << (compressing ? "write error" : "corrupt input") << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 13. 压缩基准测试：在几类合成语料上测量压缩率和编解码速度
+enum class Corpus { Uniform, Zipf, English, Runs };
+
+const char* corpusName(Corpus c) {
+    switch (c) {
+    case Corpus::Uniform: return "uniform";
+    case Corpus::Zipf: return "zipf";
+    case Corpus::English: return "english";
+    case Corpus::Runs: return "runs";
+    }
+    return "";
+}
+
+// 生成n字节的语料：均匀随机字节、Zipf分布字节（s=1.2）、按词频拼出的英文文本、随机长度的重复字节串
+vector<uint8_t> generateCorpus(Corpus kind, size_t n, unsigned seed) {
+    mt19937 gen(seed);
+    vector<uint8_t> data;
+    data.reserve(n);
+    if (kind == Corpus::Uniform) {
+        uniform_int_distribution<int> dis(0, 255);
+        while (data.size() < n) data.push_back(static_cast<uint8_t>(dis(gen)));
+    } else if (kind == Corpus::Zipf) {
+        vector<double> weights(256);
+        for (int k = 0; k < 256; ++k) weights[k] = 1.0 / pow(k + 1, 1.2);
+        discrete_distribution<int> dis(weights.begin(), weights.end());
+        vector<uint8_t> symbol(256);
+        for (int k = 0; k < 256; ++k) symbol[k] = static_cast<uint8_t>(k * 167 + 13); // 打乱字节取值
+        while (data.size() < n) data.push_back(symbol[dis(gen)]);
+    } else if (kind == Corpus::English) {
+        static const char* words[] = {
+            "the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "as", "was", "with",
+            "be", "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which",
+            "but", "have", "an", "had", "they", "you", "were", "their", "one", "all", "we",
+            "can", "her", "has", "there", "been", "if", "more", "when", "will", "would", "who",
+            "so", "no", "dream", "freedom", "hope", "justice", "nation", "together", "day"
+        };
+        const int numWords = sizeof(words) / sizeof(words[0]);
+        vector<double> weights(numWords);
+        for (int k = 0; k < numWords; ++k) weights[k] = 1.0 / (k + 1);
+        discrete_distribution<int> word(weights.begin(), weights.end());
+        uniform_int_distribution<int> sentence(5, 20);
+        while (data.size() < n) {
+            int len = sentence(gen);
+            for (int w = 0; w < len; ++w) {
+                const char* p = words[word(gen)];
+                bool capital = (w == 0);
+                for (; *p; ++p, capital = false) data.push_back(static_cast<uint8_t>(capital ? toupper(*p) : *p));
+                data.push_back(w + 1 < len ? ' ' : '.');
+            }
+            data.push_back((gen() % 8 == 0) ? '\n' : ' ');
+        }
+        data.resize(n);
+    } else {
+        uniform_int_distribution<int> value(0, 15), length(1, 64);
+        while (data.size() < n) data.insert(data.end(), length(gen), static_cast<uint8_t>('A' + value(gen)));
+        data.resize(n);
+    }
+    return data;
+}
+
+// 零阶熵（每字节位数），是任何逐字节前缀码平均长度的下界
+double entropyBits(const uint8_t* data, size_t n) {
+    uint64_t freq[256];
+    countFrequencies(data, n, freq);
+    double h = 0;
+    for (int c = 0; c < 256; ++c) {
+        if (freq[c] == 0) continue;
+        double p = static_cast<double>(freq[c]) / n;
+        h -= p * log2(p);
+    }
+    return h;
+}
+
+struct BenchResult {
+    double bitsPerSymbol;  // 含块头和编码长度表
+    double buildMicros;    // 每块由频率建表（求编码长度、分配编码、建解码表）的时间
+    double encodeMBs;
+    double decodeMBs;
+    bool roundTrip;
+};
+
+// 单线程逐块压缩再解压，分别计时
+BenchResult benchBlocks(const vector<uint8_t>& data, size_t blockSize) {
+    BenchResult result;
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    HuffBuilder builder;
+    HuffDecoder decoder;
+
+    chrono::duration<double, micro> buildTime(0);
+    for (size_t b = 0; b < numBlocks; ++b) {
+        size_t start = b * blockSize;
+        uint64_t freq[256], codes[256];
+        uint8_t lengths[256];
+        countFrequencies(data.data() + start, min(blockSize, data.size() - start), freq);
+        auto b0 = chrono::steady_clock::now();
+        builder.computeLengths(freq, 256, lengths);
+        limitCodeLengths(lengths, freq, 256, 15);
+        assignCanonicalCodes(lengths, 256, codes);
+        decoder.build(codes, lengths, 256);
+        buildTime += chrono::steady_clock::now() - b0;
+    }
+    auto t1 = chrono::steady_clock::now();
+    vector<uint8_t> packed;
+    vector<size_t> records;
+    for (size_t b = 0; b < numBlocks; ++b) {
+        size_t start = b * blockSize;
+        records.push_back(packed.size());
+        compressBlock(data.data() + start, min(blockSize, data.size() - start), builder, packed);
+    }
+    records.push_back(packed.size());
+    auto t2 = chrono::steady_clock::now();
+    vector<uint8_t> restored;
+    restored.reserve(data.size());
+    bool ok = true;
+    for (size_t b = 0; b < numBlocks && ok; ++b) {
+        const uint8_t* record = packed.data() + records[b];
+        ok = decompressBlock(record[0], record + 9, getU32(record + 5), getU32(record + 1), decoder, restored);
+    }
+    auto t3 = chrono::steady_clock::now();
+
+    double mb = data.size() / 1e6;
+    result.bitsPerSymbol = 8.0 * packed.size() / max<size_t>(data.size(), 1);
+    result.buildMicros = buildTime.count() / max<size_t>(numBlocks, 1);
+    result.encodeMBs = mb / chrono::duration<double>(t2 - t1).count();
+    result.decodeMBs = mb / chrono::duration<double>(t3 - t2).count();
+    result.roundTrip = ok && restored == data;
+    return result;
+}
+
+// 每种语料对比不同块大小的单线程结果，以及完整容器格式下的多线程流式压缩；返回是否全部无损
+bool runBenchmark(size_t megabytes) {
+    const Corpus corpora[] = { Corpus::Uniform, Corpus::Zipf, Corpus::English, Corpus::Runs };
+    const size_t blockSizes[] = { 64 * 1024, kDefaultBlockSize, 1024 * 1024 };
+    int threads = defaultThreads();
+    bool allOk = true;
+    cout << fixed << setprecision(3);
+    cout << setw(9) << "corpus" << setw(12) << "variant" << setw(10) << "entropy" << setw(10) << "bits/sym"
+         << setw(12) << "build us" << setw(12) << "enc MB/s" << setw(12) << "dec MB/s" << "  round trip" << endl;
+    for (Corpus kind : corpora) {
+        vector<uint8_t> data = generateCorpus(kind, megabytes << 20, 2024);
+        double h = entropyBits(data.data(), data.size());
+        for (size_t blockSize : blockSizes) {
+            BenchResult r = benchBlocks(data, blockSize);
+            allOk = allOk && r.roundTrip;
+            cout << setw(9) << corpusName(kind) << setw(12) << (to_string(blockSize >> 10) + "K") << setw(10) << h
+                 << setw(10) << r.bitsPerSymbol << setw(12) << r.buildMicros << setw(12) << r.encodeMBs
+                 << setw(12) << r.decodeMBs << "  " << (r.roundTrip ? "OK" : "FAILED") << endl;
+        }
+
+        // 完整的流式压缩和并行解压，数据经过内存中的字符串流
+        stringstream packed, restored;
+        auto t0 = chrono::steady_clock::now();
+        HuffStreamEncoder encoder(packed, kDefaultBlockSize, threads);
+        bool ok = encoder.feed(data.data(), data.size()) && encoder.finish();
+        auto t1 = chrono::steady_clock::now();
+        BlockIndex index;
+        ok = ok && readBlockIndex(packed, index) && decompressIndexed(packed, index, restored, threads);
+        auto t2 = chrono::steady_clock::now();
+        string text = restored.str();
+        ok = ok && text.size() == data.size() && memcmp(text.data(), data.data(), data.size()) == 0;
+        allOk = allOk && ok;
+        double mb = data.size() / 1e6;
+        cout << setw(9) << corpusName(kind) << setw(12) << ("stream x" + to_string(threads)) << setw(10) << h
+             << setw(10) << 8.0 * packed.str().size() / data.size() << setw(12) << "-"
+             << setw(12) << mb / chrono::duration<double>(t1 - t0).count()
+             << setw(12) << mb / chrono::duration<double>(t2 - t1).count() << "  " << (ok ? "OK" : "FAILED") << endl;
+
+        // 单遍自适应编码，不需要预先统计频率
+        vector<uint8_t> adaptive, decoded;
+        auto a0 = chrono::steady_clock::now();
+        AdaptiveHuffEncoder adaptiveEncoder;
+        adaptiveEncoder.put(data.data(), data.size());
+        adaptiveEncoder.finish(adaptive);
+        auto a1 = chrono::steady_clock::now();
+        AdaptiveHuffDecoder adaptiveDecoder;
+        ok = adaptiveDecoder.feed(adaptive.data(), adaptive.size(), decoded) && adaptiveDecoder.finish(decoded) &&
+             decoded == data;
+        auto a2 = chrono::steady_clock::now();
+        allOk = allOk && ok;
+        cout << setw(9) << corpusName(kind) << setw(12) << "adaptive" << setw(10) << h
+             << setw(10) << 8.0 * adaptive.size() / data.size() << setw(12) << "-"
+             << setw(12) << mb / chrono::duration<double>(a1 - a0).count()
+             << setw(12) << mb / chrono::duration<double>(a2 - a1).count() << "  " << (ok ? "OK" : "FAILED") << endl;
+    }
+    cout << defaultfloat;
+    return allOk;
+}
+
+// 用逐位的vector<bool>核对Bitmap：随机长度（含字边界两侧）和随机密度（含全0、全1），
+// 逐位比较test、rank和select（包括超出1的个数的k），以及与另一长度的位图做与、或、异或后的结果；
+// 每次比较都检查最后一个字中超出size()的位为0
+bool checkBitmap(unsigned seed) {
+    mt19937 gen(seed);
+    const size_t sizes[] = { 0, 1, 63, 64, 65, 127, 128, 129, 191, 192, 193, 1000 };
+    const double densities[] = { 0.0, 0.02, 0.5, 0.98, 1.0 };
+    uniform_real_distribution<double> coin(0.0, 1.0);
+
+    // 按随机宽度整段追加，同时覆盖appendBits跨字的路径
+    auto make = [&](size_t n, double density, vector<bool>& naive) {
+        naive.assign(n, false);
+        for (size_t i = 0; i < n; ++i) naive[i] = coin(gen) < density;
+        Bitmap bits;
+        for (size_t i = 0; i < n;) {
+            int width = static_cast<int>(min<size_t>(1 + gen() % 64, n - i));
+            uint64_t value = 0;
+            for (int j = 0; j < width; ++j) value = (value << 1) | (naive[i + j] ? 1 : 0);
+            bits.appendBits(value, width);
+            i += width;
+        }
+        return bits;
+    };
+    auto same = [](const Bitmap& bits, const vector<bool>& naive) {
+        if (bits.size() != naive.size() || bits.data().size() != (naive.size() + 63) / 64) return false;
+        size_t tail = naive.size() & 63;
+        if (tail && (bits.data().back() << tail) != 0) return false;
+        vector<size_t> ones;
+        for (size_t i = 0; i <= naive.size(); ++i) {
+            if (bits.rank(i) != ones.size()) return false;
+            if (i == naive.size()) break;
+            if (bits.test(i) != naive[i]) return false;
+            if (naive[i]) ones.push_back(i);
+        }
+        if (bits.popcount() != ones.size()) return false;
+        for (size_t k = 0; k < ones.size() + 3; ++k) {
+            if (bits.select(k) != (k < ones.size() ? ones[k] : naive.size())) return false;
+        }
+        return true;
+    };
+
+    for (size_t n : sizes) {
+        for (double density : densities) {
+            vector<bool> a, b;
+            Bitmap bitsA = make(n, density, a);
+            if (!same(bitsA, a)) return false;
+            // 另一个位图取更短、相同或更长的长度
+            size_t m = sizes[gen() % (sizeof(sizes) / sizeof(sizes[0]))];
+            Bitmap bitsB = make(m, densities[gen() % 5], b);
+            vector<bool> andRef(a), orRef(a), xorRef(a);
+            orRef.resize(max(n, m), false);
+            xorRef.resize(max(n, m), false);
+            for (size_t i = 0; i < n; ++i) andRef[i] = a[i] && i < m && b[i];
+            for (size_t i = 0; i < m; ++i) {
+                orRef[i] = orRef[i] || b[i];
+                xorRef[i] = xorRef[i] != b[i];
+            }
+            Bitmap andBits(bitsA), orBits(bitsA), xorBits(bitsA);
+            andBits &= bitsB;
+            orBits |= bitsB;
+            xorBits ^= bitsB;
+            if (!same(andBits, andRef) || !same(orBits, orRef) || !same(xorBits, xorRef)) return false;
+            // 修改后rank目录须重建
+            if (n > 0) {
+                size_t i = gen() % n;
+                bitsA.set(i, !a[i]);
+                a[i] = !a[i];
+                if (!same(bitsA, a)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 演示：字母表上的Huffman编码
+void runDemo() {
     // 统计I have a dream演讲中26个字母的频率（简化版本）
     map<char, int> letterFreq = {
         {'a', 1000}, {'b', 200},  {'c', 300},  {'d', 400},  {'e', 1200},
@@ -207,10 +1718,91 @@ int main() {
 
         // 使用HuffCode类存储编码
         HuffCode huffCode;
-        huffCode.append(encoded);
-        cout << "HuffCode: " << huffCode.toString() << endl << endl;
+        huffCode.append(huffTree, word);
+        cout << "HuffCode: " << huffCode.toString() << " (" << huffCode.bits().popcount()
+             << " ones)" << endl;
+
+        // 查表编码得到真正压缩后的字节
+        BitWriter writer;
+        huffTree.encodeBits(word, writer);
+        writer.finish();
+        cout << "Packed: " << writer.toString() << " (" << writer.bitCount() << " bits in "
+             << writer.data().size() << " bytes)" << endl;
+        cout << "Decoded: " << huffTree.decodeBits(writer.data(), word.size()) << endl << endl;
     }
 
+    // 只传输编码长度表，接收方据此重建范式编码
+    vector<uint8_t> header;
+    huffTree.writeHeader(header);
+    HuffTree rebuilt;
+    size_t pos = 0;
+    rebuilt.readHeader(header.data(), header.size(), pos);
+    BitWriter dreamBits;
+    huffTree.encodeBits("dream", dreamBits);
+    dreamBits.finish();
+    cout << "Header: " << header.size() << " bytes, decoded with rebuilt tree: "
+         << rebuilt.decodeBits(dreamBits.data(), 5) << endl;
+
+    // 频率极不均衡时编码长度也不超过15位
+    map<char, int> skewed;
+    int fa = 1, fb = 1;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        skewed[c] = fa;
+        int next = fa + fb;
+        fa = fb;
+        fb = next;
+    }
+    HuffTree limited;
+    limited.build(skewed);
+    int longest = 0;
+    for (int c = 0; c < 256; ++c) longest = max(longest, static_cast<int>(limited.codeLengths()[c]));
+    cout << "Longest code for Fibonacci frequencies: " << longest << " bits" << endl << endl;
+
+    cout << "Bitmap rank/select and bitwise ops against a bit-by-bit reference: "
+         << (checkBitmap(2024) ? "OK" : "FAILED") << endl << endl;
+
+    // 在可复用的节点数组上构造256个字符的编码长度
+    HuffBuilder builder;
+    uint64_t byteFreq[256];
+    uint8_t byteLengths[256];
+    for (int c = 0; c < 256; ++c) byteFreq[c] = 1 + (c * 2654435761u) % 10007;
+    const int rounds = 10000;
+    auto b0 = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        byteFreq[r & 255]++;
+        builder.computeLengths(byteFreq, 256, byteLengths);
+    }
+    auto b1 = chrono::steady_clock::now();
+    cout << "Building 256-symbol code lengths: "
+         << chrono::duration<double, micro>(b1 - b0).count() / rounds << " us per tree" << endl << endl;
+
+    // 查表解码与逐位走树解码的速度对比
+    string text;
+    for (int i = 0; text.size() < (1u << 22); ++i) text += testWords[i % testWords.size()];
+    BitWriter writer;
+    huffTree.encodeBits(text, writer);
+    writer.finish();
+
+    auto t0 = chrono::steady_clock::now();
+    string tableDecoded = huffTree.decodeBits(writer.data(), text.size());
+    auto t1 = chrono::steady_clock::now();
+    string walkDecoded = huffTree.decodeTreeWalk(writer.data(), text.size());
+    auto t2 = chrono::steady_clock::now();
+    double mb = text.size() / 1e6;
+    cout << "Decoding " << text.size() << " chars: table "
+         << mb / chrono::duration<double>(t1 - t0).count() << " MB/s, tree walk "
+         << mb / chrono::duration<double>(t2 - t1).count() << " MB/s, round trip "
+         << ((tableDecoded == text && walkDecoded == text) ? "OK" : "FAILED") << endl;
+}
+
+// 主函数：不带参数时运行演示，bench [MB] 运行基准测试，否则作为命令行压缩工具
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "bench") {
+        size_t megabytes = (argc > 2) ? static_cast<size_t>(stoul(argv[2])) : 16;
+        return runBenchmark(max<size_t>(megabytes, 1)) ? 0 : 1;
+    }
+    if (argc > 1) return runTool(argc, argv);
+    runDemo();
     return 0;
 }
 
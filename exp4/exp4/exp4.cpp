@@ -4,28 +4,1255 @@
 #include <stack>
 #include <algorithm>
 #include <climits>
+#include <functional>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include "../../common/mapped_file.h"
+#include "../../common/thread_pool.h"
 using namespace std;
 
+// CSR（压缩稀疏行）存储：顶点u的邻居是target[offset[u]]到target[offset[u + 1] - 1]，
+// 权重按相同下标存放在weight中；所有邻居连续存放，遍历时顺序访问内存。
+// 三个数组只以指针访问，既可以指向CSR自己持有的数组，也可以直接指向内存映射的快照文件；
+// storage保证底层存储在CSR的所有副本销毁前有效，复制CSR不复制数组
+struct CSR {
+    const long long* offset; // 长度为顶点数加1
+    const int* target;
+    const int* weight;
+    int vertices;
+    long long entries;       // 邻接表项数
+    shared_ptr<const void> storage;
+    bool owned;              // 数组由fromArrays创建，不与其他CSR共享时可以原地修改权重；映射的快照是只读的
+    bool directed;           // 有向图的邻接表，每条边只在一个端点处存放
+
+    CSR() : offset(nullptr), target(nullptr), weight(nullptr), vertices(0), entries(0), owned(false), directed(false) {}
+
+    // 接管三个数组
+    static CSR fromArrays(vector<long long>&& offsets, vector<int>&& targets, vector<int>&& weights) {
+        struct Arrays {
+            vector<long long> offset;
+            vector<int> target, weight;
+        };
+        auto arrays = make_shared<Arrays>();
+        arrays->offset = move(offsets);
+        arrays->target = move(targets);
+        arrays->weight = move(weights);
+        CSR csr;
+        csr.offset = arrays->offset.data();
+        csr.target = arrays->target.data();
+        csr.weight = arrays->weight.data();
+        csr.vertices = static_cast<int>(arrays->offset.size()) - 1;
+        csr.entries = static_cast<long long>(arrays->target.size());
+        csr.storage = arrays;
+        csr.owned = true;
+        return csr;
+    }
+
+    int degree(int u) const { return static_cast<int>(offset[u + 1] - offset[u]); }
+    long long size() const { return entries; }
+};
+
+// 检查从文件读入的邻接数组：offset从0开始单调不减并以entries结束，target都在[0, n)内。
+// 载入文件时不经过重建，不检查的话损坏的文件会使所有遍历越界访问
+bool validAdjacency(const long long* offset, const int* target, long long n, long long entries) {
+    if (offset[0] != 0 || offset[n] != entries) return false;
+    for (long long u = 0; u < n; u++) {
+        if (offset[u] > offset[u + 1]) return false;
+    }
+    for (long long i = 0; i < entries; i++) {
+        if (target[i] < 0 || target[i] >= n) return false;
+    }
+    return true;
+}
+
+// 检查无向图的邻接数组是否对称：每个顶点的(邻居, 权重)多重集与转置后的相同，
+// 即每一项u->v都有权重相同的v->u。对称时每个顶点的入度等于出度，转置可以沿用offset，
+// 按邻居计数排序得到转置后，每个顶点的两个列表排序后比较。自环的两项互为转置，
+// 另外要求同权重的自环项成对出现
+bool symmetricAdjacency(const long long* offset, const int* target, const int* weight, int n) {
+    vector<long long> inDegree(n, 0);
+    for (long long i = 0; i < offset[n]; i++) inDegree[target[i]]++;
+    for (int u = 0; u < n; u++) {
+        if (inDegree[u] != offset[u + 1] - offset[u]) return false;
+    }
+    vector<long long> pos(offset, offset + n);
+    vector<pair<int, int>> transposed(static_cast<size_t>(offset[n]));
+    for (int u = 0; u < n; u++) {
+        for (long long i = offset[u]; i < offset[u + 1]; i++) {
+            transposed[pos[target[i]]++] = { u, weight[i] };
+        }
+    }
+    vector<pair<int, int>> forward;
+    for (int u = 0; u < n; u++) {
+        forward.clear();
+        for (long long i = offset[u]; i < offset[u + 1]; i++) forward.push_back({ target[i], weight[i] });
+        sort(forward.begin(), forward.end());
+        auto first = transposed.begin() + offset[u];
+        auto last = transposed.begin() + offset[u + 1];
+        sort(first, last);
+        if (!equal(forward.begin(), forward.end(), first)) return false;
+        auto loop = lower_bound(forward.begin(), forward.end(), make_pair(u, INT_MIN));
+        for (; loop != forward.end() && loop->first == u; loop += 2) {
+            if (loop + 1 == forward.end() || *(loop + 1) != *loop) return false;
+        }
+    }
+    return true;
+}
+
+const long long kInfinity = LLONG_MAX; // 不可达顶点的距离
+
+// 一条边，有向图中从u指向v
+struct Edge {
+    int u, v, weight;
+};
+
+// BFS的结果：按层数计的距离和BFS树中的父节点，不可达顶点两者都是-1，起点的父节点是它自己
+struct BFSResult {
+    vector<int> dist;
+    vector<int> parent;
+};
+
+// DFS的结果：时间戳从0开始，每个顶点被发现和结束时各占一个，未访问的顶点为-1
+struct DFSResult {
+    vector<int> preorder;   // 按发现顺序排列的顶点
+    vector<int> postorder;  // 按结束顺序排列的顶点
+    vector<int> discovery;
+    vector<int> finish;
+    vector<int> parent;     // DFS树中的父节点，根为-1
+};
+
+// 割点和桥
+struct Biconnectivity {
+    vector<int> articulationPoints;
+    vector<Edge> bridges;
+};
+
+// 最小生成森林：每个连通分量一棵最小生成树
+struct SpanningForest {
+    vector<Edge> edges;
+    long long totalWeight;
+};
+
+// 并查集：路径减半压缩加按秩合并，单次操作的均摊代价接近常数
+class DisjointSet {
+private:
+    vector<int> parent;
+    vector<unsigned char> rank;
+
+public:
+    explicit DisjointSet(int n) : parent(n), rank(n, 0) {
+        for (int i = 0; i < n; i++) parent[i] = i;
+    }
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // 不修改结构的查找，可以在多个线程中同时调用
+    int root(int x) const {
+        while (parent[x] != x) x = parent[x];
+        return x;
+    }
+
+    // 合并x和y所在的集合，已在同一集合时返回false
+    bool unite(int x, int y) {
+        x = find(x);
+        y = find(y);
+        if (x == y) return false;
+        if (rank[x] < rank[y]) swap(x, y);
+        parent[y] = x;
+        if (rank[x] == rank[y]) rank[x]++;
+        return true;
+    }
+};
+
+// 读入整个文件：优先内存映射，失败时读到内存中；返回的对象在使用data期间须保持有效
+shared_ptr<const void> readWholeFile(const string& path, const char*& data, size_t& size) {
+    auto mapped = make_shared<MappedFile>();
+    if (mapped->open(path)) {
+        data = reinterpret_cast<const char*>(mapped->data());
+        size = mapped->size();
+        return mapped;
+    }
+    ifstream in(path, ios::binary);
+    if (!in) return nullptr;
+    auto buffer = make_shared<vector<char>>((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    data = buffer->data();
+    size = buffer->size();
+    return buffer;
+}
+
+// 图文件格式：每行"u v [w]"的边表（顶点从0编号，#或%开头为注释）、
+// DIMACS最短路格式（"p sp n m"和"a u v w"，顶点从1编号）、
+// Matrix Market坐标格式（顶点从1编号），以及Graph::saveSnapshot写出的二进制CSR快照
+enum class GraphFormat { EdgeList, Dimacs, MatrixMarket, Snapshot };
+
+GraphFormat detectFormat(const char* data, size_t size) {
+    auto startsWith = [&](const char* prefix) {
+        size_t n = strlen(prefix);
+        return size >= n && memcmp(data, prefix, n) == 0;
+    };
+    if (startsWith("CSR1")) return GraphFormat::Snapshot;
+    if (startsWith("%%MatrixMarket")) return GraphFormat::MatrixMarket;
+    if (startsWith("c ") || startsWith("c\n") || startsWith("p ")) return GraphFormat::Dimacs;
+    return GraphFormat::EdgeList;
+}
+
+// 跳过空格和制表符后解析一个十进制整数，成功时p移到数字之后
+inline bool parseInteger(const char*& p, const char* end, long long& value) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+')) p++;
+    if (p == end || *p < '0' || *p > '9') return false;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    value = negative ? -v : v;
+    return true;
+}
+
+// 解析一个可能带小数和指数的数，用于Matrix Market中的实数权重
+inline bool parseReal(const char*& p, const char* end, double& value) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+')) p++;
+    bool digits = false;
+    double v = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits = true) v = v * 10 + (*p - '0');
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, scale *= 0.1, digits = true) v += (*p - '0') * scale;
+    }
+    if (!digits) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        long long exponent;
+        p++;
+        if (!parseInteger(p, end, exponent)) return false;
+        v *= pow(10.0, static_cast<double>(exponent));
+    }
+    value = negative ? -v : v;
+    return true;
+}
+
+// 文本格式的解析参数，由文件头决定
+struct TextLayout {
+    GraphFormat format;
+    int base;               // 顶点编号的起始值
+    bool realWeights;       // Matrix Market的real类型，权重四舍五入为整数
+    bool unweighted;        // Matrix Market的pattern类型，权重都为1
+    bool mergeReverse;      // 按弧存放的文件（DIMACS和非对称的Matrix Market）载入为无向图：每项规范成u <= v，
+                            // 载入后再合并同一对顶点间的重复项，一条边只写了一个方向也不会丢失
+    bool mirror;            // 有向图载入对称的Matrix Market：文件只存一半，每项再补一条反向边
+};
+
+// 解析[p, end)中的数据行，边追加到out，maxId记录出现过的最大顶点编号；遇到格式错误返回false
+bool parseEdgeLines(const char* p, const char* end, const TextLayout& layout, vector<Edge>& out, long long& maxId) {
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (lineEnd == nullptr) lineEnd = end;
+        while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        bool data = p < lineEnd;
+        if (data && layout.format == GraphFormat::Dimacs) {
+            data = *p == 'a';
+            if (data) p++;
+        } else if (data) {
+            data = *p != '#' && *p != '%';
+        }
+        if (data) {
+            long long u, v, w = 1;
+            if (!parseInteger(p, lineEnd, u) || !parseInteger(p, lineEnd, v)) return false;
+            if (layout.realWeights) {
+                double real;
+                if (!parseReal(p, lineEnd, real)) return false;
+                w = llround(real);
+            } else if (!layout.unweighted) {
+                long long value;
+                const char* before = p;
+                if (parseInteger(p, lineEnd, value)) w = value;
+                else if (layout.format != GraphFormat::EdgeList) return false;
+                else p = before; // 边表的权重可以省略
+            }
+            while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+            if (p < lineEnd && *p != '#' && *p != '%') return false; // 行尾多余的内容
+            u -= layout.base;
+            v -= layout.base;
+            if (u < 0 || v < 0 || u >= INT_MAX || v >= INT_MAX || w < INT_MIN || w > INT_MAX) return false;
+            if (layout.mergeReverse && u > v) swap(u, v);
+            out.push_back({ static_cast<int>(u), static_cast<int>(v), static_cast<int>(w) });
+            if (layout.mirror && u != v) out.push_back({ static_cast<int>(v), static_cast<int>(u), static_cast<int>(w) });
+            maxId = max(maxId, max(u, v));
+        }
+        p = lineEnd + (lineEnd < end ? 1 : 0);
+    }
+    return true;
+}
+
+
+// 带下标的d叉最小堆：记录每个顶点在堆中的位置，可以直接减小某个顶点的键值（decrease-key），
+// 堆中不会出现同一顶点的多个副本；4叉堆比二叉堆层数少一半，下沉时比较的孩子在同一缓存行内
+class IndexedHeap {
+private:
+    static const int kArity = 4;
+    vector<int> heap;       // 堆中的顶点
+    vector<int> pos;        // 顶点在heap中的下标，不在堆中为-1
+    vector<long long> key;  // 顶点的键值
+
+    void siftUp(int i) {
+        int v = heap[i];
+        while (i > 0) {
+            int p = (i - 1) / kArity;
+            if (key[heap[p]] <= key[v]) break;
+            heap[i] = heap[p];
+            pos[heap[i]] = i;
+            i = p;
+        }
+        heap[i] = v;
+        pos[v] = i;
+    }
+
+    void siftDown(int i) {
+        int n = static_cast<int>(heap.size());
+        int v = heap[i];
+        while (true) {
+            int first = i * kArity + 1;
+            if (first >= n) break;
+            int best = first;
+            int last = min(first + kArity, n);
+            for (int c = first + 1; c < last; c++) {
+                if (key[heap[c]] < key[heap[best]]) best = c;
+            }
+            if (key[heap[best]] >= key[v]) break;
+            heap[i] = heap[best];
+            pos[heap[i]] = i;
+            i = best;
+        }
+        heap[i] = v;
+        pos[v] = i;
+    }
+
+public:
+    explicit IndexedHeap(int n = 0) : pos(n, -1), key(n) {}
+
+    // 清空并调整到n个顶点；只重置仍在堆中的顶点，重复使用时不必整体初始化
+    void reset(int n) {
+        for (int v : heap) pos[v] = -1;
+        heap.clear();
+        if (static_cast<int>(pos.size()) != n) {
+            pos.assign(n, -1);
+            key.resize(n);
+        }
+    }
+
+    bool empty() const { return heap.empty(); }
+    bool contains(int v) const { return pos[v] >= 0; }
+    long long topKey() const { return key[heap[0]]; }
+
+    // 插入顶点v，或把已在堆中的v的键值减小到k
+    void pushOrDecrease(int v, long long k) {
+        key[v] = k;
+        if (pos[v] < 0) {
+            heap.push_back(v);
+            pos[v] = static_cast<int>(heap.size()) - 1;
+        }
+        siftUp(pos[v]);
+    }
+
+    void push(int v, long long k) { pushOrDecrease(v, k); }
+
+    // 取出键值最小的顶点
+    int pop() {
+        int top = heap[0];
+        pos[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return top;
+    }
+};
+
+// 单源最短路径的结果
+struct ShortestPaths {
+    vector<long long> dist; // 不可达为kInfinity
+    vector<int> parent;     // 最短路径树中的前驱，起点和不可达顶点为-1
+
+    // 从起点到t的路径，不可达时为空
+    vector<int> pathTo(int t) const {
+        vector<int> path;
+        if (dist[t] == kInfinity) return path;
+        for (int v = t; v != -1; v = parent[v]) path.push_back(v);
+        reverse(path.begin(), path.end());
+        return path;
+    }
+};
+
+// 点到点查询的结果
+struct PathResult {
+    long long distance; // 不可达为kInfinity
+    vector<int> path;   // 从起点到终点的顶点序列，不可达时为空
+    int settled;        // 搜索过程中取出的顶点数，反映查询访问了图的多大部分
+};
+
+// 一次搜索的工作区：记录被改动过的顶点，下次查询只恢复这些顶点，
+// 点到点查询的开销与访问到的顶点数成正比，而不是与整个图的大小成正比
+struct SearchSpace {
+    vector<long long> dist;
+    vector<int> parent;
+    vector<int> touched;
+    IndexedHeap heap;
+
+    void reset(int n) {
+        if (static_cast<int>(dist.size()) != n) {
+            dist.assign(n, kInfinity);
+            parent.assign(n, -1);
+        } else {
+            for (int v : touched) {
+                dist[v] = kInfinity;
+                parent[v] = -1;
+            }
+        }
+        touched.clear();
+        heap.reset(n);
+    }
+
+    // 距离更短时更新v并返回true
+    bool relax(int v, long long d, int from) {
+        if (d >= dist[v]) return false;
+        if (dist[v] == kInfinity) touched.push_back(v);
+        dist[v] = d;
+        parent[v] = from;
+        return true;
+    }
+};
+
+// 距离矩阵：第i行是第i个起点到各目标的距离，按行连续存放，不可达为kInfinity
+struct DistanceMatrix {
+    int rows;
+    int cols;
+    vector<long long> dist;
+
+    long long at(int i, int j) const { return dist[static_cast<size_t>(i) * cols + j]; }
+};
+
+// 顶点重新编号的方式：
+//   RCM        逆Cuthill-McKee：从伪外围顶点出发按度数从小到大BFS再反转，相邻顶点的编号相近
+//   Degree     按度数从大到小，访问最频繁的高度数顶点集中在数组开头
+//   Community  仿Rabbit Order：把顶点逐个并入连接最紧密的社区，同一社区的顶点编号连续
+enum class VertexOrder { RCM, Degree, Community };
+
+const char* vertexOrderName(VertexOrder order) {
+    switch (order) {
+    case VertexOrder::RCM: return "rcm";
+    case VertexOrder::Degree: return "degree";
+    case VertexOrder::Community: return "community";
+    }
+    return "";
+}
+
+// 重新编号前后的对应关系
+struct Relabeling {
+    vector<int> newToOld;
+    vector<int> oldToNew;
+
+    // 由按新编号排列的原编号构造
+    static Relabeling fromOrder(vector<int>&& order) {
+        Relabeling r;
+        r.newToOld = move(order);
+        r.oldToNew.assign(r.newToOld.size(), -1);
+        for (size_t v = 0; v < r.newToOld.size(); v++) r.oldToNew[r.newToOld[v]] = static_cast<int>(v);
+        return r;
+    }
+
+    // 按新编号排列的逐顶点结果（距离、层数等）改为按原编号排列
+    template <typename T>
+    vector<T> toOriginal(const vector<T>& byNew) const {
+        vector<T> byOld(byNew.size());
+        for (size_t v = 0; v < byNew.size(); v++) byOld[newToOld[v]] = byNew[v];
+        return byOld;
+    }
+
+    // 顶点编号列表（路径、前驱）换回原编号，-1保持不变
+    vector<int> originalIds(const vector<int>& ids) const {
+        vector<int> result(ids.size());
+        for (size_t i = 0; i < ids.size(); i++) result[i] = ids[i] < 0 ? ids[i] : newToOld[ids[i]];
+        return result;
+    }
+};
+
 // 图的类定义
 class Graph {
 private:
     int V; // 顶点数
-    vector<vector<pair<int, int>>> adj; // 邻接表存储，pair中first是目标顶点，second是权重
+    bool directed;      // 有向图：每条边只在起点处存一次
+    vector<Edge> edges; // 尚未冻结的边，按添加顺序存放
+    vector<Edge> removed; // 等待下次冻结时删除的边
+    CSR adj;            // 冻结后的邻接表，无向图的每条边在两个端点处各存一次
+    CSR radj;           // 有向图的反向邻接表（入边），第一次用到时构造
+    bool frozen;
+    bool hasReverse;
+    SearchSpace forward, backward;   // 点到点查询的工作区
+    IndexedHeap repairHeap;          // 修复最短路径树的工作区
+    vector<bool> inSubtree;
+    int landmarkCount;
+    vector<long long> landmarkDist;  // 顶点v到第i个地标的距离存放在[v * landmarkCount + i]
 
-public:
-    // 构造函数
-    Graph(int vertices) : V(vertices) {
-        adj.resize(V);
+    // 用地标和三角不等式估计v到t距离的下界：|d(L, t) - d(L, v)| <= d(v, t)；
+    // 有向图中只有 d(L, t) - d(L, v) <= d(v, t) 成立
+    long long landmarkBound(int v, int t) const {
+        const long long* dv = &landmarkDist[static_cast<size_t>(v) * landmarkCount];
+        const long long* dt = &landmarkDist[static_cast<size_t>(t) * landmarkCount];
+        long long bound = 0;
+        for (int i = 0; i < landmarkCount; i++) {
+            if (directed) {
+                if (dv[i] == kInfinity) continue;
+                if (dt[i] == kInfinity) return kInfinity; // 地标能到v却到不了t，v也到不了t
+                bound = max(bound, dt[i] - dv[i]);
+                continue;
+            }
+            if (dv[i] == kInfinity || dt[i] == kInfinity) {
+                if (dv[i] != dt[i]) return kInfinity; // 一个可达一个不可达：不在同一连通分量
+                continue;
+            }
+            bound = max(bound, dv[i] > dt[i] ? dv[i] - dt[i] : dt[i] - dv[i]);
+        }
+        return bound;
+    }
+
+    // 沿两侧的前驱拼出经过meet的路径
+    void joinPath(int meet, PathResult& result) const {
+        for (int v = meet; v != -1; v = forward.parent[v]) result.path.push_back(v);
+        reverse(result.path.begin(), result.path.end());
+        for (int v = backward.parent[meet]; v != -1; v = backward.parent[v]) result.path.push_back(v);
+    }
+
+    // 从CSR中取出每条边一次；无向图的自环在CSR中存了两次，只取一次
+    vector<Edge> edgesFromCSR() const {
+        vector<Edge> list;
+        if (directed) {
+            list.reserve(adj.size());
+            for (int u = 0; u < V; u++) {
+                for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) list.push_back({ u, adj.target[i], adj.weight[i] });
+            }
+            return list;
+        }
+        list.reserve(adj.size() / 2);
+        for (int u = 0; u < V; u++) {
+            bool skipLoop = false;
+            for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                int v = adj.target[i];
+                if (v == u) {
+                    skipLoop = !skipLoop;
+                    if (!skipLoop) continue;
+                }
+                if (v >= u) list.push_back({ u, v, adj.weight[i] });
+            }
+        }
+        return list;
+    }
+
+    // 把CSR还原成边表，以便继续添加边
+    void thaw() {
+        vector<Edge> list = edgesFromCSR();
+        resetTo(V);
+        edges.swap(list);
+    }
+
+    // 清空图并改为n个顶点
+    void resetTo(int n) {
+        V = n;
+        edges.clear();
+        removed.clear();
+        adj = CSR();
+        radj = CSR();
+        frozen = false;
+        hasReverse = false;
+        landmarkCount = 0;
+        landmarkDist.clear();
+    }
+
+    // 无向边的两个端点不分先后
+    bool sameEdge(const Edge& e, int u, int v) const {
+        return (e.u == u && e.v == v) || (!directed && e.u == v && e.v == u);
     }
 
-    // 添加边
+    // 从边表中删除removed中的边，每项删除一条最先添加的匹配边
+    void applyRemovals() {
+        auto key = [this](int u, int v) {
+            if (!directed && u > v) swap(u, v);
+            return (static_cast<long long>(u) << 32) | static_cast<unsigned int>(v);
+        };
+        vector<long long> pending;
+        for (const Edge& e : removed) pending.push_back(key(e.u, e.v));
+        sort(pending.begin(), pending.end());
+        vector<bool> used(pending.size(), false);
+        size_t kept = 0;
+        for (const Edge& e : edges) {
+            long long k = key(e.u, e.v);
+            size_t i = lower_bound(pending.begin(), pending.end(), k) - pending.begin();
+            while (i < pending.size() && pending[i] == k && used[i]) i++;
+            if (i < pending.size() && pending[i] == k) {
+                used[i] = true;
+                continue;
+            }
+            edges[kept++] = e;
+        }
+        edges.resize(kept);
+        removed.clear();
+    }
+
+    // 在g中u的邻接表里从下标from起查找指向v的第一项，没有时返回-1
+    static long long findEntry(const CSR& g, int u, int v, long long from) {
+        for (long long i = max(from, g.offset[u]); i < g.offset[u + 1]; i++) {
+            if (g.target[i] == v) return i;
+        }
+        return -1;
+    }
+
+    // 原地修改权重前保证数组由这个CSR独占：映射的快照，以及复制图后与其他CSR共享的数组，
+    // 都先复制一份（写时复制），修改不会影响别的副本
+    static int* writableWeights(CSR& g) {
+        if (!g.owned || g.storage.use_count() > 1) {
+            bool isDirected = g.directed;
+            g = CSR::fromArrays(vector<long long>(g.offset, g.offset + g.vertices + 1),
+                                vector<int>(g.target, g.target + g.entries),
+                                vector<int>(g.weight, g.weight + g.entries));
+            g.directed = isDirected;
+        }
+        return const_cast<int*>(g.weight);
+    }
+
+    // 边a->b的权重改为w后修复以tree表示的最短路径树，只处理距离会变化的顶点。
+    // 变短时若经过a到b更近，从b开始按Dijkstra向外传播减小的距离；
+    // 变长且a->b是树边时，b的子树中的距离都可能变大：先把子树置为不可达，
+    // 再由子树外的入边求出子树顶点的候选距离，从这些顶点开始做Dijkstra。
+    // 子树外顶点的最短路径不经过a->b，距离不变
+    void repairTree(ShortestPaths& tree, int a, int b, int w) {
+        vector<long long>& dist = tree.dist;
+        vector<int>& parent = tree.parent;
+        repairHeap.reset(V);
+        if (dist[a] != kInfinity && dist[a] + w < dist[b]) {
+            dist[b] = dist[a] + w;
+            parent[b] = a;
+            repairHeap.push(b, dist[b]);
+        } else if (parent[b] == a && dist[b] != kInfinity && dist[b] < dist[a] + w) {
+            const CSR& in = reverseCsr();
+            inSubtree.resize(V, false);
+            vector<int> subtree = { b };
+            inSubtree[b] = true;
+            for (size_t k = 0; k < subtree.size(); k++) {
+                int x = subtree[k];
+                for (long long i = adj.offset[x]; i < adj.offset[x + 1]; i++) {
+                    int y = adj.target[i];
+                    if (parent[y] == x && !inSubtree[y]) {
+                        inSubtree[y] = true;
+                        subtree.push_back(y);
+                    }
+                }
+            }
+            for (int x : subtree) {
+                dist[x] = kInfinity;
+                parent[x] = -1;
+            }
+            for (int y : subtree) {
+                for (long long i = in.offset[y]; i < in.offset[y + 1]; i++) {
+                    int x = in.target[i];
+                    if (inSubtree[x] || dist[x] == kInfinity) continue;
+                    long long nd = dist[x] + in.weight[i];
+                    if (nd < dist[y]) {
+                        dist[y] = nd;
+                        parent[y] = x;
+                    }
+                }
+                if (dist[y] != kInfinity) repairHeap.push(y, dist[y]);
+            }
+            for (int x : subtree) inSubtree[x] = false;
+        }
+        while (!repairHeap.empty()) {
+            int x = repairHeap.pop();
+            for (long long i = adj.offset[x]; i < adj.offset[x + 1]; i++) {
+                int y = adj.target[i];
+                long long nd = dist[x] + adj.weight[i];
+                if (nd < dist[y]) {
+                    dist[y] = nd;
+                    parent[y] = x;
+                    repairHeap.pushOrDecrease(y, nd);
+                }
+            }
+        }
+    }
+
+    // 对u的每个邻居调用f；有向图忽略方向，出边和入边都算
+    template <typename F>
+    void forEachNeighbor(int u, const CSR& in, F f) const {
+        for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) f(adj.target[i]);
+        if (!directed) return;
+        for (long long i = in.offset[u]; i < in.offset[u + 1]; i++) f(in.target[i]);
+    }
+
+    // 忽略方向时各顶点的度数
+    vector<int> undirectedDegrees(const CSR& in) const {
+        vector<int> degree(V);
+        for (int u = 0; u < V; u++) degree[u] = adj.degree(u) + (directed ? in.degree(u) : 0);
+        return degree;
+    }
+
+    // 按度数从小到大排列的顶点，度数相同时按编号
+    static vector<int> sortedByDegree(const vector<int>& degree) {
+        vector<int> order(degree.size());
+        for (size_t v = 0; v < order.size(); v++) order[v] = static_cast<int>(v);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree[a] < degree[b]; });
+        return order;
+    }
+
+    // 从root出发BFS，按层序把到达的顶点存入reached，lastLevel是最后一层在reached中的起点；
+    // 返回最大层数，level用完后恢复为-1
+    int eccentricity(int root, const CSR& in, vector<int>& level, vector<int>& reached, size_t& lastLevel) const {
+        reached.assign(1, root);
+        level[root] = 0;
+        lastLevel = 0;
+        for (size_t k = 0; k < reached.size(); k++) {
+            int u = reached[k];
+            if (level[u] > level[reached[lastLevel]]) lastLevel = k;
+            forEachNeighbor(u, in, [&](int v) {
+                if (level[v] < 0) {
+                    level[v] = level[u] + 1;
+                    reached.push_back(v);
+                }
+            });
+        }
+        int depth = level[reached.back()];
+        for (int v : reached) level[v] = -1;
+        return depth;
+    }
+
+    // 逆Cuthill-McKee顺序。每个连通分量先用George-Liu方法找伪外围顶点：从最后一层中
+    // 度数最小的顶点重新BFS，直到层数不再增加；再从它出发BFS，每个顶点的未访问邻居按度数
+    // 从小到大加入队列。最后整体反转，使带宽和填充更小
+    vector<int> rcmOrder(const CSR& in) const {
+        vector<int> degree = undirectedDegrees(in);
+        vector<int> order;
+        order.reserve(V);
+        vector<bool> placed(V, false);
+        vector<int> level(V, -1), reached;
+        for (int start : sortedByDegree(degree)) {
+            if (placed[start]) continue;
+            int root = start;
+            size_t lastLevel;
+            int depth = eccentricity(root, in, level, reached, lastLevel);
+            for (int round = 0; round < 8; round++) {
+                int candidate = reached[lastLevel];
+                for (size_t k = lastLevel; k < reached.size(); k++) {
+                    if (degree[reached[k]] < degree[candidate]) candidate = reached[k];
+                }
+                int candidateDepth = eccentricity(candidate, in, level, reached, lastLevel);
+                if (candidateDepth <= depth) break;
+                root = candidate;
+                depth = candidateDepth;
+            }
+            size_t head = order.size();
+            order.push_back(root);
+            placed[root] = true;
+            for (; head < order.size(); head++) {
+                int u = order[head];
+                size_t first = order.size();
+                forEachNeighbor(u, in, [&](int v) {
+                    if (!placed[v]) {
+                        placed[v] = true;
+                        order.push_back(v);
+                    }
+                });
+                sort(order.begin() + first, order.end(), [&](int a, int b) {
+                    return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+                });
+            }
+        }
+        reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // 仿Rabbit Order的社区顺序。开始时每个顶点自成一个社区，按度数从小到大处理顶点u：
+    // 统计u连向各相邻社区C的边数w(u, C)，并入模块度增益 w(u, C) - deg(u) * vol(C) / 2m
+    // 最大且为正的社区，u所在的社区成为C在合并树中的孩子。最后对合并树做先序遍历，
+    // 同一社区（以及先合并的更紧密的子社区）的顶点得到连续的编号。
+    // 边数只按u自身的边统计，不合并社区的邻接表，是原算法的近似，代价为O(E)
+    vector<int> communityOrder(const CSR& in) const {
+        vector<int> degree = undirectedDegrees(in);
+        double twoM = 0;
+        for (int d : degree) twoM += d;
+        vector<int> head(V), firstChild(V, -1), lastChild(V, -1), nextSibling(V, -1);
+        vector<long long> volume(V);
+        for (int v = 0; v < V; v++) {
+            head[v] = v;
+            volume[v] = degree[v];
+        }
+        auto find = [&](int v) {
+            while (head[v] != v) {
+                head[v] = head[head[v]];
+                v = head[v];
+            }
+            return v;
+        };
+        vector<int> weightTo(V, 0), touched;
+        for (int u : sortedByDegree(degree)) {
+            // u尚未被处理过，只可能有别的社区并入它，它仍是自己社区的代表
+            touched.clear();
+            forEachNeighbor(u, in, [&](int v) {
+                int c = find(v);
+                if (c == u) return;
+                if (weightTo[c]++ == 0) touched.push_back(c);
+            });
+            int best = -1;
+            double bestGain = 0;
+            for (int c : touched) {
+                double gain = weightTo[c] - degree[u] * static_cast<double>(volume[c]) / twoM;
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    best = c;
+                }
+                weightTo[c] = 0;
+            }
+            if (best < 0) continue;
+            head[u] = best;
+            volume[best] += volume[u];
+            if (lastChild[best] < 0) firstChild[best] = u;
+            else nextSibling[lastChild[best]] = u;
+            lastChild[best] = u;
+        }
+        vector<int> order;
+        order.reserve(V);
+        vector<int> stack;
+        for (int root = 0; root < V; root++) {
+            if (head[root] != root) continue;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int v = stack.back();
+                stack.pop_back();
+                order.push_back(v);
+                // 孩子按合并顺序输出，倒序压栈
+                size_t mark = stack.size();
+                for (int c = firstChild[v]; c >= 0; c = nextSibling[c]) stack.push_back(c);
+                reverse(stack.begin() + mark, stack.end());
+            }
+        }
+        return order;
+    }
+
+    // 解析文本格式：先读文件头，再把数据部分按行切成若干段并行解析，各段的边按文件顺序拼接
+    bool loadText(const char* data, size_t size, GraphFormat format, int threads) {
+        // 有向图保留DIMACS和非对称Matrix Market中的每一条弧，无向图把正反两条弧合并成一条边
+        TextLayout layout = { format, format == GraphFormat::EdgeList ? 0 : 1, false, false,
+                              !directed && format == GraphFormat::Dimacs, false };
+        const char* p = data;
+        const char* end = data + size;
+        auto nextLine = [&](const char* q) {
+            const char* nl = static_cast<const char*>(memchr(q, '\n', end - q));
+            return nl ? nl + 1 : end;
+        };
+        long long declared = 0; // 文件头声明的顶点数
+        if (format == GraphFormat::MatrixMarket) {
+            const char* lineEnd = nextLine(p);
+            string header(p, lineEnd);
+            transform(header.begin(), header.end(), header.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+            if (header.find("coordinate") == string::npos) return false;
+            layout.realWeights = header.find("real") != string::npos;
+            layout.unweighted = header.find("pattern") != string::npos;
+            bool symmetric = header.find("symmetric") != string::npos;
+            layout.mergeReverse = !directed && !symmetric;
+            layout.mirror = directed && symmetric;
+            p = lineEnd;
+            while (p < end && (*p == '%' || *p == '\n' || *p == '\r')) p = nextLine(p);
+            long long rows, cols, entries;
+            if (!parseInteger(p, end, rows) || !parseInteger(p, end, cols) || !parseInteger(p, end, entries)) return false;
+            declared = max(rows, cols);
+            p = nextLine(p);
+        } else if (format == GraphFormat::Dimacs) {
+            // 文件头中的"p sp 顶点数 边数"
+            for (const char* q = p; q < end && *q != 'a'; q = nextLine(q)) {
+                if (*q != 'p') continue;
+                q++;
+                while (q < end && (*q == ' ' || *q == '\t')) q++;
+                while (q < end && *q != ' ' && *q != '\t' && *q != '\n') q++;
+                if (!parseInteger(q, end, declared)) return false;
+                break;
+            }
+        }
+        if (declared < 0 || declared > INT_MAX) return false;
+
+        ThreadPool pool(threads);
+        size_t chunks = max<size_t>(1, min<size_t>(pool.size() * 4, (end - p) / (1 << 16)));
+        vector<const char*> bounds(chunks + 1, end);
+        bounds[0] = p;
+        for (size_t c = 1; c < chunks; c++) {
+            const char* q = p + (end - p) / chunks * c;
+            bounds[c] = max(bounds[c - 1], q > p ? nextLine(q - 1) : p);
+        }
+        vector<vector<Edge>> parts(chunks);
+        vector<long long> maxIds(chunks, -1);
+        vector<char> ok(chunks, 1);
+        pool.parallelFor(chunks, [&](size_t c, int) {
+            ok[c] = parseEdgeLines(bounds[c], bounds[c + 1], layout, parts[c], maxIds[c]);
+        });
+        long long maxId = -1;
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; c++) {
+            if (!ok[c]) return false;
+            maxId = max(maxId, maxIds[c]);
+            total += parts[c].size();
+        }
+        if (maxId >= INT_MAX) return false;
+        resetTo(static_cast<int>(max(declared, maxId + 1)));
+        edges.reserve(total);
+        for (auto& part : parts) {
+            edges.insert(edges.end(), part.begin(), part.end());
+            vector<Edge>().swap(part);
+        }
+        if (layout.mergeReverse) {
+            // 同一对顶点的各项排在一起，只保留权重最小的一项
+            sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+                return a.u != b.u ? a.u < b.u : (a.v != b.v ? a.v < b.v : a.weight < b.weight);
+            });
+            edges.erase(unique(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+                return a.u == b.u && a.v == b.v;
+            }), edges.end());
+        }
+        freeze();
+        return true;
+    }
+
+    // 直接使用快照中的数组，不做拷贝；file保证数据在图的生命周期内有效
+    bool loadSnapshot(const shared_ptr<const void>& file, const char* data, size_t size) {
+        if (size < 24) return false;
+        uint32_t flags;
+        uint64_t counts[2];
+        memcpy(&flags, data + 4, sizeof(flags));
+        memcpy(counts, data + 8, sizeof(counts));
+        uint64_t n = counts[0], entries = counts[1];
+        if (n >= static_cast<uint64_t>(INT_MAX) || entries > (size - 24) / 8) return false;
+        uint64_t targetBytes = (4 * entries + 7) / 8 * 8; // target段补齐到8字节
+        if (size != 24 + 8 * (n + 1) + targetBytes + 4 * entries) return false;
+        CSR view;
+        view.offset = reinterpret_cast<const long long*>(data + 24);
+        view.target = reinterpret_cast<const int*>(data + 24 + 8 * (n + 1));
+        view.weight = reinterpret_cast<const int*>(data + 24 + 8 * (n + 1) + targetBytes);
+        view.vertices = static_cast<int>(n);
+        view.entries = static_cast<long long>(entries);
+        view.storage = file;
+        view.directed = (flags & 1) != 0;
+        if (!validAdjacency(view.offset, view.target, view.vertices, view.entries)) return false;
+        // 无向图的每条边在两端各存一项，不对称的文件会使反向查找和修改权重失配
+        if (!view.directed && !symmetricAdjacency(view.offset, view.target, view.weight, view.vertices)) return false;
+        resetTo(static_cast<int>(n));
+        directed = (flags & 1) != 0;
+        adj = view;
+        frozen = true;
+        return true;
+    }
+
+    // 用堆实现的Dijkstra，heap由调用方提供以便重复使用；图需已冻结
+    void runDijkstra(int source, int target, IndexedHeap& heap, ShortestPaths& result) const {
+        result.dist.assign(V, kInfinity);
+        result.parent.assign(V, -1);
+        heap.reset(V);
+        result.dist[source] = 0;
+        heap.push(source, 0);
+        while (!heap.empty()) {
+            int u = heap.pop();
+            if (u == target) break;
+            long long du = result.dist[u];
+            for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                int v = adj.target[i];
+                long long nd = du + adj.weight[i];
+                if (nd < result.dist[v]) {
+                    result.dist[v] = nd;
+                    result.parent[v] = u;
+                    heap.pushOrDecrease(v, nd);
+                }
+            }
+        }
+    }
+
+public:
+    // 构造函数，isDirected为真时是有向图
+    Graph(int vertices, bool isDirected = false)
+        : V(vertices), directed(isDirected), frozen(false), hasReverse(false), landmarkCount(0) {}
+
+    // 添加边，有向图中从u指向v；图已冻结时先还原成边表
     void addEdge(int u, int v, int weight) {
-        adj[u].push_back({ v, weight });
-        adj[v].push_back({ u, weight }); // 无向图
+        if (frozen) thaw();
+        edges.push_back({ u, v, weight });
+    }
+
+    // 删除u到v的一条边（无向图不分先后），有多条时删除最先添加的一条，没有时不做任何事。
+    // 删除先记下来，下次冻结时一并完成，连续删除多条边只重建一次CSR
+    void removeEdge(int u, int v) {
+        if (frozen) thaw();
+        removed.push_back({ u, v, 0 });
+    }
+
+    // 把u到v的边（有多条时是最先添加的一条）的权重改为weight，没有这条边时返回false。
+    // 已冻结时直接修改CSR中的权重，不重建；权重变小会使地标下界失效，此时丢弃地标
+    bool updateWeight(int u, int v, int weight) {
+        if (!frozen) {
+            for (Edge& e : edges) {
+                if (sameEdge(e, u, v)) {
+                    e.weight = weight;
+                    return true;
+                }
+            }
+            return false;
+        }
+        long long i = findEntry(adj, u, v, 0);
+        if (i < 0) return false;
+        // 先找到另一端的对应项再修改，找不到时不改动任何权重；自环的两项在同一个邻接表中相邻
+        long long j = -1;
+        if (!directed) {
+            j = findEntry(adj, v, u, u == v ? i + 1 : 0);
+            if (j < 0) return false;
+        } else if (hasReverse) {
+            j = findEntry(radj, v, u, 0);
+            if (j < 0) return false;
+        }
+        if (weight < adj.weight[i]) {
+            landmarkCount = 0;
+            landmarkDist.clear();
+        }
+        writableWeights(adj)[i] = weight;
+        if (!directed) {
+            writableWeights(adj)[j] = weight;
+        } else if (hasReverse) {
+            writableWeights(radj)[j] = weight;
+        }
+        return true;
+    }
+
+    // 修改权重并修复tree：tree须是修改前在当前图上完整求出（未指定target）的最短路径，
+    // 只重新计算距离受影响的顶点，比重新运行Dijkstra快得多
+    bool updateWeight(int u, int v, int weight, ShortestPaths& tree) {
+        freeze();
+        if (!updateWeight(u, v, weight)) return false;
+        repairTree(tree, u, v, weight);
+        if (!directed && u != v) repairTree(tree, v, u, weight);
+        return true;
+    }
+
+    // 用计数排序把边表转成CSR：先数出每个顶点的度数，前缀和得到起点，再按边的顺序依次填入，
+    // 每个顶点的邻居顺序与逐条添加到邻接表时相同；冻结后释放边表
+    void freeze() {
+        if (frozen) return;
+        if (!removed.empty()) applyRemovals();
+        vector<long long> offset(V + 1, 0);
+        for (const Edge& e : edges) {
+            offset[e.u + 1]++;
+            if (!directed) offset[e.v + 1]++;
+        }
+        for (int u = 0; u < V; u++) offset[u + 1] += offset[u];
+        vector<int> target(offset[V]), weight(offset[V]);
+        vector<long long> pos(offset.begin(), offset.end() - 1);
+        for (const Edge& e : edges) {
+            long long i = pos[e.u]++;
+            target[i] = e.v;
+            weight[i] = e.weight;
+            if (directed) continue;
+            long long j = pos[e.v]++;
+            target[j] = e.u;
+            weight[j] = e.weight;
+        }
+        adj = CSR::fromArrays(move(offset), move(target), move(weight));
+        adj.directed = directed;
+        edges.clear();
+        edges.shrink_to_fit();
+        frozen = true;
+    }
+
+    // 冻结后的邻接表
+    const CSR& csr() {
+        freeze();
+        return adj;
+    }
+
+    // 反向邻接表：顶点v的入边，无向图就是csr()；有向图第一次调用时按终点计数排序构造
+    const CSR& reverseCsr() {
+        freeze();
+        if (!directed) return adj;
+        if (!hasReverse) {
+            vector<long long> offset(V + 1, 0);
+            for (long long i = 0; i < adj.size(); i++) offset[adj.target[i] + 1]++;
+            for (int u = 0; u < V; u++) offset[u + 1] += offset[u];
+            vector<int> target(offset[V]), weight(offset[V]);
+            vector<long long> pos(offset.begin(), offset.end() - 1);
+            for (int u = 0; u < V; u++) {
+                for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                    long long j = pos[adj.target[i]]++;
+                    target[j] = u;
+                    weight[j] = adj.weight[i];
+                }
+            }
+            radj = CSR::fromArrays(move(offset), move(target), move(weight));
+            radj.directed = true;
+            hasReverse = true;
+        }
+        return radj;
+    }
+
+    int vertexCount() const { return V; }
+    bool isDirected() const { return directed; }
+
+    // 从文件载入图，替换当前的全部内容，格式按文件开头自动识别；
+    // 文件优先以内存映射方式读取，快照文件直接作为CSR使用，不经过解析和排序。
+    // 文本格式按当前图是否有向解释，快照按文件中的标志
+    bool load(const string& path, int threads = defaultThreads()) {
+        const char* data = nullptr;
+        size_t size = 0;
+        shared_ptr<const void> file = readWholeFile(path, data, size);
+        if (!file) return false;
+        GraphFormat format = detectFormat(data, size);
+        if (format == GraphFormat::Snapshot) return loadSnapshot(file, data, size);
+        return loadText(data, size, format, threads);
+    }
+
+    // 保存二进制快照：["CSR1"][标志 u32][顶点数 u64][表项数 u64] offset target [补齐] weight，本机字节序；
+    // 标志的第0位表示有向图。表项数为奇数时target后补4个零字节，各数组的起点都按8字节对齐，
+    // 载入时可以直接映射使用
+    bool saveSnapshot(const string& path) {
+        freeze();
+        ofstream out(path, ios::binary);
+        uint32_t flags = directed ? 1 : 0;
+        uint64_t counts[2] = { static_cast<uint64_t>(V), static_cast<uint64_t>(adj.size()) };
+        out.write("CSR1", 4);
+        out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+        out.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+        out.write(reinterpret_cast<const char*>(adj.offset), sizeof(long long) * (V + 1));
+        out.write(reinterpret_cast<const char*>(adj.target), sizeof(int) * adj.size());
+        const char padding[4] = {};
+        if (adj.size() % 2 != 0) out.write(padding, sizeof(padding));
+        out.write(reinterpret_cast<const char*>(adj.weight), sizeof(int) * adj.size());
+        return static_cast<bool>(out);
+    }
+
+    // 方向优化的并行BFS（Beamer）：逐层推进，每层在线程池上并行处理。
+    // 前沿较小时自顶向下，由前沿顶点检查邻居，用原子操作抢占访问位；
+    // 前沿的出边数超过未访问顶点边数的1/14时改为自底向上，由每个未访问顶点查找
+    // 位图前沿中的邻居（有向图中是入边的起点），找到一个就停止；前沿顶点数少于V/24时再切换回来
+    BFSResult parallelBFS(int source, int threads = defaultThreads()) {
+        const CSR& in = reverseCsr();
+        const int kAlpha = 14, kBeta = 24;
+        const size_t kChunk = 1 << 12; // 每个任务处理的顶点数，是64的倍数，使位图的字不跨任务
+        ThreadPool pool(threads);
+        BFSResult result;
+        result.dist.assign(V, -1);
+        result.parent.assign(V, -1);
+        size_t words = (static_cast<size_t>(V) + 63) / 64;
+        vector<atomic<uint64_t>> visited(words);
+        for (auto& w : visited) w.store(0, memory_order_relaxed);
+        vector<uint64_t> frontierBits, nextBits;
+        vector<int> frontier = { source };
+        vector<vector<int>> local(pool.size());
+        vector<long long> localEdges(pool.size()); // 各线程新访问顶点的边数
+        vector<long long> localFound(pool.size());
+
+        visited[source / 64].fetch_or(1ull << (source % 64), memory_order_relaxed);
+        result.dist[source] = 0;
+        result.parent[source] = source;
+        long long unexploredEdges = adj.size() - adj.degree(source); // 未访问顶点的边数
+        long long frontierEdges = adj.degree(source);
+        bool bottomUp = false;
+        size_t frontierSize = 1;
+        for (int level = 0; frontierSize > 0; level++) {
+            if (!bottomUp && frontierEdges > unexploredEdges / kAlpha) {
+                // 队列前沿转成位图
+                bottomUp = true;
+                frontierBits.assign(words, 0);
+                for (int v : frontier) frontierBits[v / 64] |= 1ull << (v % 64);
+            } else if (bottomUp && frontierSize < static_cast<size_t>(V) / kBeta) {
+                // 位图前沿转成队列
+                bottomUp = false;
+                frontier.clear();
+                for (size_t w = 0; w < words; w++) {
+                    if (frontierBits[w] == 0) continue;
+                    for (int b = 0; b < 64; b++) {
+                        if ((frontierBits[w] >> b) & 1) frontier.push_back(static_cast<int>(w * 64 + b));
+                    }
+                }
+            }
+            fill(localEdges.begin(), localEdges.end(), 0);
+            fill(localFound.begin(), localFound.end(), 0);
+
+            if (bottomUp) {
+                nextBits.assign(words, 0);
+                pool.parallelFor((V + kChunk - 1) / kChunk, [&](size_t c, int id) {
+                    int end = static_cast<int>(min(static_cast<size_t>(V), (c + 1) * kChunk));
+                    long long edges = 0, found = 0;
+                    for (int v = static_cast<int>(c * kChunk); v < end; v++) {
+                        if (visited[v / 64].load(memory_order_relaxed) & (1ull << (v % 64))) continue;
+                        for (long long i = in.offset[v]; i < in.offset[v + 1]; i++) {
+                            int u = in.target[i];
+                            if (frontierBits[u / 64] & (1ull << (u % 64))) {
+                                result.parent[v] = u;
+                                result.dist[v] = level + 1;
+                                nextBits[v / 64] |= 1ull << (v % 64);
+                                edges += adj.degree(v);
+                                found++;
+                                break;
+                            }
+                        }
+                    }
+                    localEdges[id] += edges;
+                    localFound[id] += found;
+                });
+                // 本层结束后再统一标记访问位，避免同一层内新访问的顶点被当成前沿
+                for (size_t w = 0; w < words; w++) visited[w].fetch_or(nextBits[w], memory_order_relaxed);
+                frontierSize = 0;
+                for (long long n : localFound) frontierSize += n;
+                frontierBits.swap(nextBits);
+            } else {
+                size_t tasks = (frontier.size() + kChunk - 1) / kChunk;
+                for (auto& l : local) l.clear();
+                pool.parallelFor(tasks, [&](size_t c, int id) {
+                    size_t end = min(frontier.size(), (c + 1) * kChunk);
+                    for (size_t k = c * kChunk; k < end; k++) {
+                        int u = frontier[k];
+                        for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                            int v = adj.target[i];
+                            uint64_t bit = 1ull << (v % 64);
+                            if (visited[v / 64].load(memory_order_relaxed) & bit) continue;
+                            if (visited[v / 64].fetch_or(bit, memory_order_relaxed) & bit) continue;
+                            result.parent[v] = u;
+                            result.dist[v] = level + 1;
+                            local[id].push_back(v);
+                            localEdges[id] += adj.degree(v);
+                        }
+                    }
+                });
+                frontier.clear();
+                for (auto& l : local) frontier.insert(frontier.end(), l.begin(), l.end());
+                frontierSize = frontier.size();
+            }
+            frontierEdges = 0;
+            for (long long e : localEdges) frontierEdges += e;
+            unexploredEdges -= frontierEdges;
+        }
+        return result;
     }
 
     // BFS实现
     void BFS(int start) {
+        freeze();
         vector<bool> visited(V, false);
         queue<int> q;
 
@@ -39,8 +1266,8 @@ public:
             cout << v << " ";
             q.pop();
 
-            for (auto& neighbor : adj[v]) {
-                int next = neighbor.first;
+            for (long long i = adj.offset[v]; i < adj.offset[v + 1]; i++) {
+                int next = adj.target[i];
                 if (!visited[next]) {
                     visited[next] = true;
                     q.push(next);
@@ -50,123 +1277,1098 @@ public:
         cout << endl;
     }
 
-    // DFS实现
+    // 用显式栈代替递归的DFS：栈中保存顶点和下一条要检查的边，访问顺序与递归版本相同，
+    // 长链上也不会耗尽调用栈。start为-1时依次从每个未访问的顶点出发，遍历整个图
+    DFSResult depthFirst(int start = -1) {
+        freeze();
+        DFSResult result;
+        result.discovery.assign(V, -1);
+        result.finish.assign(V, -1);
+        result.parent.assign(V, -1);
+        result.preorder.reserve(V);
+        result.postorder.reserve(V);
+        vector<pair<int, long long>> stack;
+        int clock = 0;
+        for (int root = (start < 0 ? 0 : start); root < V; root++) {
+            if (result.discovery[root] >= 0) continue;
+            result.discovery[root] = clock++;
+            result.preorder.push_back(root);
+            stack.push_back({ root, adj.offset[root] });
+            while (!stack.empty()) {
+                int u = stack.back().first;
+                long long& i = stack.back().second;
+                if (i == adj.offset[u + 1]) {
+                    result.finish[u] = clock++;
+                    result.postorder.push_back(u);
+                    stack.pop_back();
+                    continue;
+                }
+                int v = adj.target[i++];
+                if (result.discovery[v] >= 0) continue;
+                result.discovery[v] = clock++;
+                result.parent[v] = u;
+                result.preorder.push_back(v);
+                stack.push_back({ v, adj.offset[v] });
+            }
+            if (start >= 0) break;
+        }
+        return result;
+    }
+
+    // 连通分量：返回每个顶点所属分量的编号（从0开始），count为分量数；有向图求弱连通分量
+    vector<int> connectedComponents(int& count) {
+        const CSR& in = reverseCsr();
+        vector<int> component(V, -1);
+        vector<int> stack;
+        auto visit = [&](const CSR& g, int u) {
+            for (long long i = g.offset[u]; i < g.offset[u + 1]; i++) {
+                int v = g.target[i];
+                if (component[v] < 0) {
+                    component[v] = count;
+                    stack.push_back(v);
+                }
+            }
+        };
+        count = 0;
+        for (int root = 0; root < V; root++) {
+            if (component[root] >= 0) continue;
+            component[root] = count;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int u = stack.back();
+                stack.pop_back();
+                visit(adj, u);
+                if (directed) visit(in, u);
+            }
+            count++;
+        }
+        return component;
+    }
+
+    // 图是否有环。无向图：DFS中遇到已访问且不是父节点的邻居即有环，
+    // 通往父节点的边只跳过一次，两点间的重边和自环也算作环；有向图：不存在拓扑序即有环
+    bool hasCycle() {
+        if (directed) return V > 0 && topologicalOrder().empty();
+        freeze();
+        vector<int> parent(V, -1);
+        vector<bool> visited(V, false);
+        vector<pair<int, long long>> stack;
+        vector<bool> skippedParent(V, false);
+        for (int root = 0; root < V; root++) {
+            if (visited[root]) continue;
+            visited[root] = true;
+            stack.push_back({ root, adj.offset[root] });
+            while (!stack.empty()) {
+                int u = stack.back().first;
+                long long& i = stack.back().second;
+                if (i == adj.offset[u + 1]) {
+                    stack.pop_back();
+                    continue;
+                }
+                int v = adj.target[i++];
+                if (v == parent[u] && !skippedParent[u]) {
+                    skippedParent[u] = true;
+                    continue;
+                }
+                if (visited[v]) return true;
+                visited[v] = true;
+                parent[v] = u;
+                stack.push_back({ v, adj.offset[v] });
+            }
+        }
+        return false;
+    }
+
+    // 拓扑排序：把邻接表中的每一项看作一条有向边，按DFS结束时间的逆序排列；
+    // 遇到仍在栈中的顶点说明有环，返回空数组。无向图的每条边都构成两点间的环，只对有向图有意义
+    vector<int> topologicalOrder() {
+        freeze();
+        vector<unsigned char> state(V, 0); // 0未访问，1在栈中，2已结束
+        vector<int> order;
+        order.reserve(V);
+        vector<pair<int, long long>> stack;
+        for (int root = 0; root < V; root++) {
+            if (state[root]) continue;
+            state[root] = 1;
+            stack.push_back({ root, adj.offset[root] });
+            while (!stack.empty()) {
+                int u = stack.back().first;
+                long long& i = stack.back().second;
+                if (i == adj.offset[u + 1]) {
+                    state[u] = 2;
+                    order.push_back(u);
+                    stack.pop_back();
+                    continue;
+                }
+                int v = adj.target[i++];
+                if (state[v] == 1) return {};
+                if (state[v] == 0) {
+                    state[v] = 1;
+                    stack.push_back({ v, adj.offset[v] });
+                }
+            }
+        }
+        reverse(order.begin(), order.end());
+        return order;
+    }
+
+    // Tarjan算法求割点和桥：low[v]是v的子树经过至多一条非树边能到达的最小发现时间。
+    // 非根顶点u有孩子v满足low[v] >= disc[u]时u是割点，根有两个以上孩子时是割点；
+    // low[v] > disc[u]时树边u-v是桥。通往父节点的边只跳过一次，重边不会被当成桥；只适用于无向图
+    Biconnectivity biconnectivity() {
+        freeze();
+        Biconnectivity result;
+        vector<int> disc(V, -1), low(V, 0), parent(V, -1), parentWeight(V, 0);
+        vector<bool> skippedParent(V, false), isArticulation(V, false);
+        vector<pair<int, long long>> stack;
+        int clock = 0;
+        for (int root = 0; root < V; root++) {
+            if (disc[root] >= 0) continue;
+            int rootChildren = 0;
+            disc[root] = low[root] = clock++;
+            stack.push_back({ root, adj.offset[root] });
+            while (!stack.empty()) {
+                int u = stack.back().first;
+                long long& i = stack.back().second;
+                if (i < adj.offset[u + 1]) {
+                    int v = adj.target[i];
+                    int w = adj.weight[i];
+                    i++;
+                    if (v == parent[u] && !skippedParent[u]) {
+                        skippedParent[u] = true;
+                        continue;
+                    }
+                    if (disc[v] >= 0) {
+                        low[u] = min(low[u], disc[v]);
+                        continue;
+                    }
+                    disc[v] = low[v] = clock++;
+                    parent[v] = u;
+                    parentWeight[v] = w;
+                    if (u == root) rootChildren++;
+                    stack.push_back({ v, adj.offset[v] });
+                    continue;
+                }
+                stack.pop_back();
+                int p = parent[u];
+                if (p < 0) continue;
+                low[p] = min(low[p], low[u]);
+                if (p != root && low[u] >= disc[p]) isArticulation[p] = true;
+                if (low[u] > disc[p]) result.bridges.push_back({ p, u, parentWeight[u] });
+            }
+            if (rootChildren > 1) isArticulation[root] = true;
+        }
+        for (int v = 0; v < V; v++) {
+            if (isArticulation[v]) result.articulationPoints.push_back(v);
+        }
+        return result;
+    }
+
+    // DFS实现：按发现顺序打印从v出发访问到的顶点
     void DFSUtil(int v, vector<bool>& visited) {
+        vector<pair<int, long long>> stack;
         visited[v] = true;
         cout << v << " ";
-
-        for (auto& neighbor : adj[v]) {
-            int next = neighbor.first;
+        stack.push_back({ v, adj.offset[v] });
+        while (!stack.empty()) {
+            int u = stack.back().first;
+            long long& i = stack.back().second;
+            if (i == adj.offset[u + 1]) {
+                stack.pop_back();
+                continue;
+            }
+            int next = adj.target[i++];
             if (!visited[next]) {
-                DFSUtil(next, visited);
+                visited[next] = true;
+                cout << next << " ";
+                stack.push_back({ next, adj.offset[next] });
             }
         }
     }
 
     void DFS(int start) {
+        freeze();
         vector<bool> visited(V, false);
         cout << "DFS starting from vertex " << start << ": ";
         DFSUtil(start, visited);
         cout << endl;
     }
 
-    // Dijkstra最短路径算法
-    void dijkstra(int start) {
-        vector<int> dist(V, INT_MAX);
-        vector<bool> visited(V, false);
+    // 单源最短路径，返回每个顶点的距离和路径上的前驱；给定target时求出它的距离后立即停止，
+    // 此时其余顶点的结果不完整
+    ShortestPaths shortestPaths(int source, int target = -1) {
+        freeze();
+        ShortestPaths result;
+        IndexedHeap heap(V);
+        runDijkstra(source, target, heap, result);
+        return result;
+    }
 
-        dist[start] = 0;
+    // 桶队列（Dial算法）版本：距离相差不超过最大边权，按距离对(最大边权 + 1)取模放入循环桶，
+    // 每次取出最小距离的操作均摊为常数；适合边权是较小非负整数的图，最大边权过大时改用堆。
+    // 逐个扫描的桶数等于最大距离，最坏约为V·C（C为最大边权），而堆的代价约为(V + E)·log V次
+    // 堆操作；检查一个空桶比一次堆操作便宜得多，按4倍计，C超过4(V + E)·log V / V时改用堆。
+    // 这个界也限制了桶数组的大小
+    ShortestPaths shortestPathsBucket(int source, int target = -1) {
+        freeze();
+        int maxWeight = 0;
+        for (long long i = 0; i < adj.size(); i++) maxWeight = max(maxWeight, adj.weight[i]);
+        long long logV = 1;
+        while ((1LL << logV) < V) logV++;
+        long long limit = 4 * (V + adj.size()) * logV / max(V, 1);
+        if (maxWeight > limit) return shortestPaths(source, target);
 
-        for (int count = 0; count < V - 1; count++) {
-            int u = -1;
-            int min_dist = INT_MAX;
+        ShortestPaths result;
+        result.dist.assign(V, kInfinity);
+        result.parent.assign(V, -1);
+        vector<vector<int>> buckets(maxWeight + 1);
+        result.dist[source] = 0;
+        buckets[0].push_back(source);
+        long long pending = 1; // 桶中尚未取出的顶点数（含已过时的）
+        for (long long d = 0; pending > 0; d++) {
+            vector<int>& bucket = buckets[d % (maxWeight + 1)];
+            // 处理时可能向同一个桶追加（权重为0的边），按下标遍历
+            for (size_t k = 0; k < bucket.size(); k++) {
+                int u = bucket[k];
+                pending--;
+                if (result.dist[u] != d) continue; // 已经以更短的距离处理过
+                if (u == target) return result;
+                for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                    int v = adj.target[i];
+                    long long nd = d + adj.weight[i];
+                    if (nd < result.dist[v]) {
+                        result.dist[v] = nd;
+                        result.parent[v] = u;
+                        buckets[nd % (maxWeight + 1)].push_back(v);
+                        pending++;
+                    }
+                }
+            }
+            bucket.clear();
+        }
+        return result;
+    }
 
-            // 找到当前最短距离的顶点
-            for (int v = 0; v < V; v++) {
-                if (!visited[v] && dist[v] < min_dist) {
-                    min_dist = dist[v];
-                    u = v;
+    // 双向Dijkstra：从s和t同时搜索，每次扩展堆顶较小的一侧，
+    // 两侧堆顶之和不小于已找到的最短路径时停止，访问的顶点通常远少于单向搜索；
+    // 从t出发的一侧沿入边搜索
+    PathResult shortestPath(int s, int t) {
+        const CSR& in = reverseCsr();
+        PathResult result = { kInfinity, {}, 0 };
+        forward.reset(V);
+        backward.reset(V);
+        forward.relax(s, 0, -1);
+        forward.heap.push(s, 0);
+        backward.relax(t, 0, -1);
+        backward.heap.push(t, 0);
+        int meet = (s == t) ? s : -1;
+        if (s == t) result.distance = 0;
+        while (!forward.heap.empty() && !backward.heap.empty()) {
+            if (forward.heap.topKey() + backward.heap.topKey() >= result.distance) break;
+            bool fromSource = forward.heap.topKey() <= backward.heap.topKey();
+            SearchSpace& side = fromSource ? forward : backward;
+            const SearchSpace& other = fromSource ? backward : forward;
+            const CSR& g = fromSource ? adj : in;
+            int u = side.heap.pop();
+            result.settled++;
+            for (long long i = g.offset[u]; i < g.offset[u + 1]; i++) {
+                int v = g.target[i];
+                long long nd = side.dist[u] + g.weight[i];
+                if (side.relax(v, nd, u)) side.heap.pushOrDecrease(v, nd);
+                if (other.dist[v] != kInfinity && side.dist[v] + other.dist[v] < result.distance) {
+                    result.distance = side.dist[v] + other.dist[v];
+                    meet = v;
                 }
             }
+        }
+        if (meet >= 0) joinPath(meet, result);
+        return result;
+    }
+
+    // A*搜索：按 距离 + heuristic(v) 的顺序扩展，heuristic(v)须是v到t距离的下界，
+    // 例如按坐标算出的直线距离乘以单位长度的最小边权；下界越紧，访问的顶点越少
+    PathResult shortestPathAStar(int s, int t, const function<long long(int)>& heuristic) {
+        freeze();
+        PathResult result = { kInfinity, {}, 0 };
+        forward.reset(V);
+        backward.reset(V);
+        forward.relax(s, 0, -1);
+        forward.heap.push(s, heuristic(s));
+        while (!forward.heap.empty()) {
+            int u = forward.heap.pop();
+            result.settled++;
+            if (u == t) break;
+            for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                int v = adj.target[i];
+                long long nd = forward.dist[u] + adj.weight[i];
+                if (!forward.relax(v, nd, u)) continue;
+                long long h = heuristic(v);
+                if (h != kInfinity) forward.heap.pushOrDecrease(v, nd + h);
+            }
+        }
+        if (forward.dist[t] != kInfinity) {
+            result.distance = forward.dist[t];
+            joinPath(t, result);
+        }
+        return result;
+    }
 
-            if (u == -1) break;
+    // 选取count个地标并预先计算所有顶点到地标的距离（ALT）：第一个地标是顶点0，
+    // 之后每次选离已有地标最远的顶点，使地标分散在图的边缘
+    void buildLandmarks(int count) {
+        freeze();
+        count = max(0, min(count, V));
+        landmarkCount = count;
+        landmarkDist.assign(static_cast<size_t>(V) * count, kInfinity);
+        vector<long long> nearest(V, kInfinity); // 到已选地标的最近距离
+        ShortestPaths sp;
+        IndexedHeap heap(V);
+        int next = 0;
+        for (int i = 0; i < count; i++) {
+            runDijkstra(next, -1, heap, sp);
+            for (int v = 0; v < V; v++) {
+                landmarkDist[static_cast<size_t>(v) * count + i] = sp.dist[v];
+                nearest[v] = min(nearest[v], sp.dist[v]);
+            }
+            // 下一个地标：优先取尚无地标可达的顶点，否则取离地标最远的顶点
+            long long far = -1;
+            for (int v = 0; v < V; v++) {
+                long long key = (nearest[v] == kInfinity) ? LLONG_MAX : nearest[v];
+                if (key > far) {
+                    far = key;
+                    next = v;
+                }
+            }
+        }
+    }
 
-            visited[u] = true;
+    // 使用地标下界的A*查询，需先调用buildLandmarks
+    PathResult shortestPathALT(int s, int t) {
+        if (landmarkCount == 0) return shortestPath(s, t);
+        return shortestPathAStar(s, t, [this, t](int v) { return landmarkBound(v, t); });
+    }
 
-            // 更新相邻顶点的距离
-            for (auto& neighbor : adj[u]) {
-                int v = neighbor.first;
-                int weight = neighbor.second;
+    // 多源最短路径：sources中的起点在线程池上并行，各自做一次完整的Dijkstra，
+    // 每个线程重复使用自己的堆和距离数组；targets为空时列是全部顶点，否则按targets的顺序
+    DistanceMatrix distanceMatrix(const vector<int>& sources, const vector<int>& targets = {},
+                                  int threads = defaultThreads()) {
+        freeze();
+        DistanceMatrix matrix;
+        matrix.rows = static_cast<int>(sources.size());
+        matrix.cols = targets.empty() ? V : static_cast<int>(targets.size());
+        matrix.dist.resize(static_cast<size_t>(matrix.rows) * matrix.cols);
+        ThreadPool pool(threads);
+        vector<IndexedHeap> heaps(pool.size());
+        vector<ShortestPaths> trees(pool.size());
+        pool.parallelFor(sources.size(), [&](size_t k, int id) {
+            runDijkstra(sources[k], -1, heaps[id], trees[id]);
+            long long* row = &matrix.dist[k * matrix.cols];
+            const vector<long long>& dist = trees[id].dist;
+            if (targets.empty()) copy(dist.begin(), dist.end(), row);
+            else for (int j = 0; j < matrix.cols; j++) row[j] = dist[targets[j]];
+        });
+        return matrix;
+    }
 
-                if (!visited[v] && dist[u] != INT_MAX &&
-                    dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
+    // 分块Floyd-Warshall，求全部顶点之间的距离，适合顶点数在几千以内的稠密图。
+    // 矩阵分成kTile x kTile的块，第k轮先在对角块内部迭代，再更新第k块行和第k块列，
+    // 最后用这两者更新其余的块；后两步中各块互不依赖，在线程池上并行。每块只占32KB，
+    // 内层循环连续且没有分支，编译器可以向量化。不可达在计算中用不会溢出的大数表示；
+    // 边权可以为负，但不能有负环
+    DistanceMatrix floydWarshall(int threads = defaultThreads()) {
+        freeze();
+        const int kTile = 64;
+        const long long kUnreached = LLONG_MAX / 4;
+        const size_t n = static_cast<size_t>(V);
+        DistanceMatrix matrix;
+        matrix.rows = matrix.cols = V;
+        matrix.dist.assign(n * n, kUnreached);
+        long long* d = matrix.dist.data();
+        for (int u = 0; u < V; u++) {
+            d[u * n + u] = 0;
+            for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                long long& cell = d[u * n + adj.target[i]];
+                cell = min(cell, static_cast<long long>(adj.weight[i]));
+            }
+        }
+        // 用(ib, kb)块和(kb, jb)块更新(ib, jb)块；k在最外层，块与块重叠时也正确
+        auto relaxTile = [&](int ib, int jb, int kb) {
+            int iEnd = min(V, (ib + 1) * kTile), jEnd = min(V, (jb + 1) * kTile), kEnd = min(V, (kb + 1) * kTile);
+            int j0 = jb * kTile;
+            for (int k = kb * kTile; k < kEnd; k++) {
+                const long long* rowK = d + k * n;
+                for (int i = ib * kTile; i < iEnd; i++) {
+                    long long* rowI = d + i * n;
+                    long long dik = rowI[k];
+                    for (int j = j0; j < jEnd; j++) {
+                        long long via = dik + rowK[j];
+                        rowI[j] = via < rowI[j] ? via : rowI[j];
+                    }
                 }
             }
+        };
+        ThreadPool pool(threads);
+        int tiles = (V + kTile - 1) / kTile;
+        for (int kb = 0; kb < tiles; kb++) {
+            relaxTile(kb, kb, kb);
+            pool.parallelFor(2 * static_cast<size_t>(tiles), [&](size_t t, int) {
+                int b = static_cast<int>(t / 2);
+                if (b == kb) return;
+                if (t % 2 == 0) relaxTile(kb, b, kb);
+                else relaxTile(b, kb, kb);
+            });
+            pool.parallelFor(static_cast<size_t>(tiles) * tiles, [&](size_t t, int) {
+                int ib = static_cast<int>(t / tiles), jb = static_cast<int>(t % tiles);
+                if (ib != kb && jb != kb) relaxTile(ib, jb, kb);
+            });
         }
+        for (long long& x : matrix.dist) {
+            if (x >= kUnreached / 2) x = kInfinity;
+        }
+        return matrix;
+    }
+
+    // Dijkstra最短路径算法，打印从start到各顶点的距离
+    void dijkstra(int start) {
+        ShortestPaths result = shortestPaths(start);
 
         cout << "Shortest distances from vertex " << start << ":\n";
         for (int i = 0; i < V; i++) {
-            cout << "To " << i << ": " << dist[i] << endl;
+            cout << "To " << i << ": ";
+            if (result.dist[i] == kInfinity) cout << "unreachable" << endl;
+            else cout << result.dist[i] << endl;
         }
     }
 
-    // Prim最小生成树算法
-    void primMST() {
+    // 所有边，每条一次
+    vector<Edge> edgeList() {
+        freeze();
+        return edgesFromCSR();
+    }
+
+    // 用堆实现的Prim算法：从每个尚未加入的顶点出发各长出一棵树，得到最小生成森林。
+    // 生成树只对无向图有定义；有向图只沿出边生长，忽略方向的森林请用Kruskal或Borůvka
+    SpanningForest primForest() {
+        freeze();
+        SpanningForest forest = { {}, 0 };
         vector<int> parent(V, -1);
-        vector<int> key(V, INT_MAX);
+        vector<int> key(V);               // parent[v] != -1时有效：连向树的最轻边的权重
         vector<bool> inMST(V, false);
+        IndexedHeap heap(V);
+        for (int root = 0; root < V; root++) {
+            if (inMST[root]) continue;
+            heap.push(root, 0);
+            while (!heap.empty()) {
+                int u = heap.pop();
+                inMST[u] = true;
+                if (parent[u] != -1) {
+                    forest.edges.push_back({ parent[u], u, key[u] });
+                    forest.totalWeight += key[u];
+                }
+                for (long long i = adj.offset[u]; i < adj.offset[u + 1]; i++) {
+                    int v = adj.target[i];
+                    // 用parent判断是否已有候选边，不用INT_MAX作未到达的标记，权重为INT_MAX的边同样会被选中
+                    if (!inMST[v] && (parent[v] == -1 || adj.weight[i] < key[v])) {
+                        key[v] = adj.weight[i];
+                        parent[v] = u;
+                        heap.pushOrDecrease(v, key[v]);
+                    }
+                }
+            }
+        }
+        return forest;
+    }
 
-        key[0] = 0;
-
-        for (int count = 0; count < V - 1; count++) {
-            int u = -1;
-            int min_key = INT_MAX;
+    // Kruskal算法：边按权重排序后依次加入，用并查集跳过会形成环的边
+    SpanningForest kruskalForest() {
+        freeze();
+        SpanningForest forest = { {}, 0 };
+        vector<Edge> list = edgesFromCSR();
+        sort(list.begin(), list.end(), [](const Edge& a, const Edge& b) { return a.weight < b.weight; });
+        DisjointSet sets(V);
+        for (const Edge& e : list) {
+            if (!sets.unite(e.u, e.v)) continue;
+            forest.edges.push_back(e);
+            forest.totalWeight += e.weight;
+            if (static_cast<int>(forest.edges.size()) == V - 1) break;
+        }
+        return forest;
+    }
 
-            // 找到权值最小的顶点
+    // 并行Borůvka算法：每轮各线程分段扫描边，用原子操作为每个分量记下最轻的出边，
+    // 再把这些边全部加入并合并分量；每轮分量数至少减半，最多进行log V轮。
+    // 权重相同时按边的下标比较，保证所有边有全序，同一轮选出的边不会成环
+    SpanningForest boruvkaForest(int threads = defaultThreads()) {
+        freeze();
+        SpanningForest forest = { {}, 0 };
+        vector<Edge> list = edgesFromCSR();
+        ThreadPool pool(threads);
+        DisjointSet sets(V);
+        vector<int> comp(V);
+        for (int v = 0; v < V; v++) comp[v] = v;
+        // 键的高32位是把符号位翻转后的权重（使无符号比较与有符号权重的大小一致），低32位是边的下标
+        const uint64_t kNone = UINT64_MAX;
+        vector<atomic<uint64_t>> cheapest(V);
+        const size_t chunk = 1 << 16;
+        size_t chunks = (list.size() + chunk - 1) / chunk;
+        while (true) {
+            for (int v = 0; v < V; v++) cheapest[v].store(kNone, memory_order_relaxed);
+            pool.parallelFor(chunks, [&](size_t c, int) {
+                size_t end = min(list.size(), (c + 1) * chunk);
+                for (size_t i = c * chunk; i < end; i++) {
+                    int a = comp[list[i].u], b = comp[list[i].v];
+                    if (a == b) continue;
+                    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(list[i].weight) ^ 0x80000000u) << 32) | i;
+                    for (int side : { a, b }) {
+                        uint64_t cur = cheapest[side].load(memory_order_relaxed);
+                        while (key < cur && !cheapest[side].compare_exchange_weak(cur, key, memory_order_relaxed)) {}
+                    }
+                }
+            });
+            bool merged = false;
             for (int v = 0; v < V; v++) {
-                if (!inMST[v] && key[v] < min_key) {
-                    min_key = key[v];
-                    u = v;
+                uint64_t key = cheapest[v].load(memory_order_relaxed);
+                if (key == kNone) continue;
+                const Edge& e = list[key & 0xffffffffu];
+                if (sets.unite(e.u, e.v)) {
+                    forest.edges.push_back(e);
+                    forest.totalWeight += e.weight;
+                    merged = true;
                 }
             }
+            if (!merged) break;
+            pool.parallelFor((V + chunk - 1) / chunk, [&](size_t c, int) {
+                int end = static_cast<int>(min(static_cast<size_t>(V), (c + 1) * chunk));
+                for (int v = static_cast<int>(c * chunk); v < end; v++) comp[v] = sets.root(v);
+            });
+        }
+        return forest;
+    }
 
-            if (u == -1) break;
+    // Prim最小生成树算法，打印最小生成森林的边和总权重
+    void primMST() {
+        SpanningForest forest = primForest();
+        cout << "Minimum Spanning Tree edges:\n";
+        for (const Edge& e : forest.edges) {
+            cout << e.u << " - " << e.v << endl;
+        }
+        cout << "Total MST weight: " << forest.totalWeight << endl;
+    }
 
-            inMST[u] = true;
+    // 计算一种顶点顺序，不修改图
+    Relabeling vertexOrder(VertexOrder kind) {
+        const CSR& in = reverseCsr();
+        if (kind == VertexOrder::RCM) return Relabeling::fromOrder(rcmOrder(in));
+        if (kind == VertexOrder::Community) return Relabeling::fromOrder(communityOrder(in));
+        vector<int> degree = undirectedDegrees(in);
+        vector<int> order(V);
+        for (int v = 0; v < V; v++) order[v] = v;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree[a] > degree[b]; });
+        return Relabeling::fromOrder(move(order));
+    }
 
-            // 更新相邻顶点的权值
-            for (auto& neighbor : adj[u]) {
-                int v = neighbor.first;
-                int weight = neighbor.second;
+    // 把顶点u改称relabeling.oldToNew[u]并重建CSR，每个顶点的邻居按新编号排序，
+    // 遍历时对dist、visited等数组的访问尽量顺序进行。之后的参数和结果都使用新编号，
+    // 用relabeling换算；地标和反向邻接表随之作废
+    void relabel(const Relabeling& relabeling) {
+        freeze();
+        const vector<int>& newToOld = relabeling.newToOld;
+        const vector<int>& oldToNew = relabeling.oldToNew;
+        vector<long long> offset(V + 1, 0);
+        for (int u = 0; u < V; u++) offset[u + 1] = offset[u] + adj.degree(newToOld[u]);
+        vector<int> target(offset[V]), weight(offset[V]);
+        vector<pair<int, int>> row;
+        for (int u = 0; u < V; u++) {
+            int old = newToOld[u];
+            row.clear();
+            for (long long i = adj.offset[old]; i < adj.offset[old + 1]; i++) row.push_back({ oldToNew[adj.target[i]], adj.weight[i] });
+            // 稳定排序：重边和自环的两项保持原来的相对顺序
+            stable_sort(row.begin(), row.end(), [](const pair<int, int>& a, const pair<int, int>& b) { return a.first < b.first; });
+            for (size_t k = 0; k < row.size(); k++) {
+                target[offset[u] + k] = row[k].first;
+                weight[offset[u] + k] = row[k].second;
+            }
+        }
+        adj = CSR::fromArrays(move(offset), move(target), move(weight));
+        adj.directed = directed;
+        radj = CSR();
+        hasReverse = false;
+        landmarkCount = 0;
+        landmarkDist.clear();
+    }
 
-                if (!inMST[v] && weight < key[v]) {
-                    parent[v] = u;
-                    key[v] = weight;
-                }
+    // 计算顶点顺序并按它重新编号，返回新旧编号的对应关系
+    Relabeling reorder(VertexOrder kind) {
+        Relabeling relabeling = vertexOrder(kind);
+        relabel(relabeling);
+        return relabeling;
+    }
+};
+
+// 收缩层次（Contraction Hierarchies）：按重要性从低到高依次收缩顶点，收缩v时若两个邻居间
+// 经过v的路径是唯一最短路径，就在两者之间加一条捷径；每个顶点只保留通往更高层顶点的边（上行图）。
+// 查询时从两端各自只沿上行边做Dijkstra，两侧都在最高层附近相遇，只需访问很少的顶点。
+// 无向图中下行图就是上行图的反向，查询两侧共用同一个上行CSR，因此只适用于无向图
+class ContractionHierarchy {
+private:
+    int V;
+    vector<int> rank;            // 收缩顺序，越大越重要
+    vector<long long> offset;    // 上行图：顶点u通往更高层顶点的边
+    vector<int> target;
+    vector<long long> weight;    // 捷径的权重可能超出int
+    SearchSpace forward, backward;
+
+    // 收缩过程中的动态图，只包含尚未收缩的顶点之间的边
+    vector<vector<pair<int, long long>>> work;
+    vector<bool> contracted;
+    vector<int> deletedNeighbors;  // 已收缩的邻居数
+    vector<int> level;             // 顶点在层次中的深度：收缩的邻居深度加1
+    SearchSpace witness;
+    vector<int> isTarget;          // 见证搜索的目标标记，等于stamp时有效
+    int stamp;
+    vector<pair<pair<int, int>, long long>> shortcuts; // 最近一次求出的捷径
+
+    static const int kWitnessLimit = 500; // 见证搜索最多取出的顶点数
+
+    // 把u-v边的权重更新为min(原权重, w)，没有这条边时添加
+    void addWorkEdge(int u, int v, long long w) {
+        for (auto& e : work[u]) {
+            if (e.first == v) {
+                e.second = min(e.second, w);
+                return;
             }
         }
+        work[u].push_back({ v, w });
+    }
 
-        cout << "Minimum Spanning Tree edges:\n";
-        int totalWeight = 0;
-        for (int i = 1; i < V; i++) {
-            if (parent[i] != -1) {
-                cout << parent[i] << " - " << i << endl;
-                // 找到对应的边权重
-                for (auto& edge : adj[i]) {
-                    if (edge.first == parent[i]) {
-                        totalWeight += edge.second;
+    // 从u出发、不经过skip的有限Dijkstra：所有目标都已取出、距离超过limit
+    // 或取出顶点数达到上限时停止；没找到见证路径只会多加捷径，不影响正确性
+    void witnessSearch(int u, int skip, long long limit, int targets) {
+        witness.reset(V);
+        witness.relax(u, 0, -1);
+        witness.heap.push(u, 0);
+        int settled = 0;
+        while (!witness.heap.empty() && settled < kWitnessLimit && targets > 0) {
+            if (witness.heap.topKey() > limit) break;
+            int x = witness.heap.pop();
+            settled++;
+            if (isTarget[x] == stamp) targets--;
+            for (const auto& e : work[x]) {
+                if (e.first == skip) continue;
+                long long nd = witness.dist[x] + e.second;
+                if (witness.relax(e.first, nd, x)) witness.heap.pushOrDecrease(e.first, nd);
+            }
+        }
+    }
+
+    // 求收缩v需要的捷径，结果放在shortcuts中
+    void findShortcuts(int v) {
+        const auto& nbrs = work[v];
+        shortcuts.clear();
+        for (size_t i = 0; i + 1 < nbrs.size(); i++) {
+            long long limit = 0;
+            ++stamp;
+            for (size_t j = i + 1; j < nbrs.size(); j++) {
+                limit = max(limit, nbrs[i].second + nbrs[j].second);
+                isTarget[nbrs[j].first] = stamp;
+            }
+            witnessSearch(nbrs[i].first, v, limit, static_cast<int>(nbrs.size() - i - 1));
+            for (size_t j = i + 1; j < nbrs.size(); j++) {
+                long long via = nbrs[i].second + nbrs[j].second;
+                if (witness.dist[nbrs[j].first] <= via) continue; // 有不经过v的不更长的路径
+                shortcuts.push_back({ { nbrs[i].first, nbrs[j].first }, via });
+            }
+        }
+    }
+
+    // 优先级：两倍边差（加入的捷径数减去删除的边数）加上已收缩的邻居数和深度，
+    // 后两项使收缩在图上均匀推进、层次不会过深；计算后shortcuts中是收缩v需要的捷径
+    long long priority(int v) {
+        findShortcuts(v);
+        long long edgeDifference = static_cast<long long>(shortcuts.size()) - static_cast<long long>(work[v].size());
+        return 2 * edgeDifference + deletedNeighbors[v] + level[v];
+    }
+
+public:
+    ContractionHierarchy() : V(0), stamp(0) {}
+
+    // 由图的CSR构造收缩层次；有向图的下行图不是上行图的反向，不支持，返回false
+    bool build(const CSR& g) {
+        if (g.directed) {
+            V = 0;
+            rank.clear();
+            offset.assign(1, 0);
+            target.clear();
+            weight.clear();
+            return false;
+        }
+        V = g.vertices;
+        work.assign(V, {});
+        for (int u = 0; u < V; u++) {
+            for (long long i = g.offset[u]; i < g.offset[u + 1]; i++) {
+                if (g.target[i] != u) addWorkEdge(u, g.target[i], g.weight[i]);
+            }
+        }
+        contracted.assign(V, false);
+        rank.assign(V, 0);
+        deletedNeighbors.assign(V, 0);
+        level.assign(V, 0);
+        isTarget.assign(V, 0);
+        stamp = 0;
+        priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> order;
+        for (int v = 0; v < V; v++) order.push({ priority(v), v });
+
+        vector<pair<int, pair<int, long long>>> up; // (u, (v, w))：u通往更高层顶点v的边
+        int next = 0;
+        while (!order.empty()) {
+            int v = order.top().second;
+            order.pop();
+            if (contracted[v]) continue;
+            // 惰性更新：重新计算的优先级不再是最小时放回队列
+            long long p = priority(v);
+            if (!order.empty() && p > order.top().first) {
+                order.push({ p, v });
+                continue;
+            }
+            for (const auto& sc : shortcuts) {
+                addWorkEdge(sc.first.first, sc.first.second, sc.second);
+                addWorkEdge(sc.first.second, sc.first.first, sc.second);
+            }
+            for (const auto& e : work[v]) {
+                up.push_back({ v, e });
+                auto& back = work[e.first];
+                for (size_t k = 0; k < back.size(); k++) {
+                    if (back[k].first == v) {
+                        back[k] = back.back();
+                        back.pop_back();
                         break;
                     }
                 }
+                deletedNeighbors[e.first]++;
+                level[e.first] = max(level[e.first], level[v] + 1);
             }
+            work[v].clear();
+            work[v].shrink_to_fit();
+            contracted[v] = true;
+            rank[v] = next++;
+        }
+        work.clear();
+        contracted.clear();
+        deletedNeighbors.clear();
+        level.clear();
+        isTarget.clear();
+
+        // 按起点计数排序成CSR
+        offset.assign(V + 1, 0);
+        for (const auto& e : up) offset[e.first + 1]++;
+        for (int u = 0; u < V; u++) offset[u + 1] += offset[u];
+        target.resize(up.size());
+        weight.resize(up.size());
+        vector<long long> pos(offset.begin(), offset.end() - 1);
+        for (const auto& e : up) {
+            long long i = pos[e.first]++;
+            target[i] = e.second.first;
+            weight[i] = e.second.second;
         }
-        cout << "Total MST weight: " << totalWeight << endl;
+        return true;
     }
+
+    // s到t的最短距离，不可达为kInfinity
+    long long distance(int s, int t) {
+        forward.reset(V);
+        backward.reset(V);
+        forward.relax(s, 0, -1);
+        forward.heap.push(s, 0);
+        backward.relax(t, 0, -1);
+        backward.heap.push(t, 0);
+        long long best = kInfinity;
+        while (!forward.heap.empty() || !backward.heap.empty()) {
+            // 两侧都只向上走，某一侧堆顶不小于best后就不必再扩展
+            bool forwardDone = forward.heap.empty() || forward.heap.topKey() >= best;
+            bool backwardDone = backward.heap.empty() || backward.heap.topKey() >= best;
+            if (forwardDone && backwardDone) break;
+            bool fromSource = !forwardDone &&
+                              (backwardDone || forward.heap.topKey() <= backward.heap.topKey());
+            SearchSpace& side = fromSource ? forward : backward;
+            const SearchSpace& other = fromSource ? backward : forward;
+            int u = side.heap.pop();
+            if (other.dist[u] != kInfinity) best = min(best, side.dist[u] + other.dist[u]);
+            // 按需停滞：某个更高层的邻居能给出更短的距离时，u的距离不是最短的，不从u继续扩展
+            bool stalled = false;
+            for (long long i = offset[u]; i < offset[u + 1] && !stalled; i++) {
+                stalled = side.dist[target[i]] != kInfinity && side.dist[target[i]] + weight[i] < side.dist[u];
+            }
+            if (stalled) continue;
+            for (long long i = offset[u]; i < offset[u + 1]; i++) {
+                long long nd = side.dist[u] + weight[i];
+                if (side.relax(target[i], nd, u)) side.heap.pushOrDecrease(target[i], nd);
+            }
+        }
+        return best;
+    }
+
+    int vertexCount() const { return V; }
+    long long edgeCount() const { return static_cast<long long>(target.size()); }
+
+    // 保存为二进制文件：["CHG1"][顶点数 u64][边数 u64] rank offset target weight，本机字节序
+    bool save(const string& path) const {
+        ofstream out(path, ios::binary);
+        uint64_t header[2] = { static_cast<uint64_t>(V), static_cast<uint64_t>(target.size()) };
+        out.write("CHG1", 4);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(rank.data()), rank.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(offset.data()), offset.size() * sizeof(long long));
+        out.write(reinterpret_cast<const char*>(target.data()), target.size() * sizeof(int));
+        out.write(reinterpret_cast<const char*>(weight.data()), weight.size() * sizeof(long long));
+        return static_cast<bool>(out);
+    }
+
+    // 载入save写出的文件，文件长度与头部不符或数组损坏时返回false
+    bool load(const string& path) {
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) return false;
+        uint64_t size = static_cast<uint64_t>(in.tellg());
+        in.seekg(0);
+        char magic[4];
+        uint64_t header[2];
+        if (!in.read(magic, 4) || string(magic, 4) != "CHG1") return false;
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] >= INT_MAX) return false;
+        // 先按文件长度核对边数，避免按损坏的头部分配过大的数组
+        uint64_t fixed = 20 + 4 * header[0] + 8 * (header[0] + 1);
+        if (size < fixed || (size - fixed) % 12 != 0 || (size - fixed) / 12 != header[1]) return false;
+        V = static_cast<int>(header[0]);
+        rank.resize(V);
+        offset.resize(V + 1);
+        target.resize(header[1]);
+        weight.resize(header[1]);
+        in.read(reinterpret_cast<char*>(rank.data()), rank.size() * sizeof(int));
+        in.read(reinterpret_cast<char*>(offset.data()), offset.size() * sizeof(long long));
+        in.read(reinterpret_cast<char*>(target.data()), target.size() * sizeof(int));
+        in.read(reinterpret_cast<char*>(weight.data()), weight.size() * sizeof(long long));
+        if (!in || !validAdjacency(offset.data(), target.data(), V, static_cast<long long>(header[1]))) {
+            V = 0;
+            return false;
+        }
+        return true;
+    }
+};
+
+// 顶点重排基准测试：在几类合成图上比较重新编号前后的遍历速度
+enum class GraphShape { Road, PowerLaw, Community };
+
+const char* graphShapeName(GraphShape shape) {
+    switch (shape) {
+    case GraphShape::Road: return "road";
+    case GraphShape::PowerLaw: return "powerlaw";
+    case GraphShape::Community: return "community";
+    }
+    return "";
+}
+
+// 生成约n个顶点的无向图，顶点编号随机打乱，模拟编号与结构无关的输入；边权为1到100：
+//   road       正方形网格
+//   powerlaw   R-MAT（a = 0.57, b = c = 0.19），平均度数约16，度数呈幂律分布
+//   community  大小32到512的社区，平均度数约8，九成的边在社区内
+Graph generateGraph(GraphShape shape, int n, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> weight(1, 100);
+    vector<Edge> list;
+    if (shape == GraphShape::Road) {
+        int side = max(2, static_cast<int>(sqrt(static_cast<double>(n))));
+        n = side * side;
+        for (int r = 0; r < side; r++) {
+            for (int c = 0; c < side; c++) {
+                int v = r * side + c;
+                if (c + 1 < side) list.push_back({ v, v + 1, weight(gen) });
+                if (r + 1 < side) list.push_back({ v, v + side, weight(gen) });
+            }
+        }
+    } else if (shape == GraphShape::PowerLaw) {
+        int scale = 1;
+        while ((1 << scale) < n) scale++;
+        n = 1 << scale;
+        uniform_real_distribution<double> dis(0.0, 1.0);
+        for (long long k = 0; k < 8LL * n; k++) {
+            int u = 0, v = 0;
+            for (int bit = 0; bit < scale; bit++) {
+                double r = dis(gen);
+                if (r >= 0.57 + 0.19 + 0.19) u |= 1 << bit, v |= 1 << bit;
+                else if (r >= 0.57 + 0.19) u |= 1 << bit;
+                else if (r >= 0.57) v |= 1 << bit;
+            }
+            if (u != v) list.push_back({ u, v, weight(gen) });
+        }
+    } else {
+        uniform_int_distribution<int> size(32, 512), any(0, n - 1);
+        for (int first = 0; first < n;) {
+            int end = min(n, first + size(gen));
+            uniform_int_distribution<int> member(first, end - 1);
+            for (int u = first; u < end; u++) {
+                // 每个顶点发出4条边，加上别的顶点连来的边，平均度数为8
+                for (int k = 0; k < 4; k++) {
+                    int v = (gen() % 10 == 0) ? any(gen) : member(gen);
+                    if (v != u) list.push_back({ u, v, weight(gen) });
+                }
+            }
+            first = end;
+        }
+    }
+    vector<int> label(n);
+    for (int v = 0; v < n; v++) label[v] = v;
+    shuffle(label.begin(), label.end(), gen);
+    Graph g(n);
+    for (const Edge& e : list) g.addEdge(label[e.u], label[e.v], e.weight);
+    g.freeze();
+    return g;
+}
+
+// 相邻顶点编号之差的对数的平均值，越小说明邻居在数组中越集中
+double averageLogGap(const CSR& g) {
+    double sum = 0;
+    for (int u = 0; u < g.vertices; u++) {
+        for (long long i = g.offset[u]; i < g.offset[u + 1]; i++) sum += log2(1.0 + abs(g.target[i] - u));
+    }
+    return g.size() > 0 ? sum / g.size() : 0;
+}
+
+struct TraversalTimes {
+    double bfsMillis;       // 单线程BFS，每个起点的平均时间
+    double dijkstraMillis;
+    vector<long long> firstDist; // 第一个起点的最短距离，按原编号排列，用于核对结果
 };
 
-// 测试主函数
-int main() {
+// 从sources中的每个起点各做一次BFS和Dijkstra
+TraversalTimes timeTraversals(Graph& g, const vector<int>& sources, const Relabeling* relabeling) {
+    TraversalTimes times = { 0, 0, {} };
+    for (size_t k = 0; k < sources.size(); k++) {
+        int s = relabeling ? relabeling->oldToNew[sources[k]] : sources[k];
+        auto t0 = chrono::steady_clock::now();
+        g.parallelBFS(s, 1);
+        auto t1 = chrono::steady_clock::now();
+        ShortestPaths sp = g.shortestPaths(s);
+        auto t2 = chrono::steady_clock::now();
+        times.bfsMillis += chrono::duration<double, milli>(t1 - t0).count();
+        times.dijkstraMillis += chrono::duration<double, milli>(t2 - t1).count();
+        if (k == 0) times.firstDist = relabeling ? relabeling->toOriginal(sp.dist) : sp.dist;
+    }
+    times.bfsMillis /= max<size_t>(sources.size(), 1);
+    times.dijkstraMillis /= max<size_t>(sources.size(), 1);
+    return times;
+}
+
+// 每类图对比原始的随机编号和三种重排，输出重排耗时、编号间距和遍历的加速比；返回结果是否全部一致
+bool runReorderBenchmark(int vertices) {
+    const GraphShape shapes[] = { GraphShape::Road, GraphShape::PowerLaw, GraphShape::Community };
+    const VertexOrder orders[] = { VertexOrder::RCM, VertexOrder::Degree, VertexOrder::Community };
+    bool allOk = true;
+    cout << fixed << setprecision(2);
+    cout << setw(10) << "graph" << setw(11) << "order" << setw(12) << "reorder ms" << setw(9) << "log gap"
+         << setw(10) << "BFS ms" << setw(9) << "speedup" << setw(13) << "Dijkstra ms" << setw(9) << "speedup"
+         << "  same result" << endl;
+    for (GraphShape shape : shapes) {
+        Graph original = generateGraph(shape, vertices, 2024);
+        // 起点取随机边的端点，避免落在幂律图中大量的孤立顶点上
+        mt19937 gen(7);
+        const CSR& adj = original.csr();
+        vector<int> sources(4);
+        for (int& s : sources) s = adj.size() > 0 ? adj.target[gen() % adj.size()] : 0;
+        TraversalTimes base = timeTraversals(original, sources, nullptr);
+        cout << setw(10) << graphShapeName(shape) << setw(11) << "random" << setw(12) << "-"
+             << setw(9) << averageLogGap(original.csr()) << setw(10) << base.bfsMillis << setw(9) << 1.0
+             << setw(13) << base.dijkstraMillis << setw(9) << 1.0 << "  -" << endl;
+        for (VertexOrder order : orders) {
+            Graph g = original;
+            auto t0 = chrono::steady_clock::now();
+            Relabeling relabeling = g.reorder(order);
+            auto t1 = chrono::steady_clock::now();
+            TraversalTimes times = timeTraversals(g, sources, &relabeling);
+            bool same = times.firstDist == base.firstDist;
+            allOk = allOk && same;
+            cout << setw(10) << graphShapeName(shape) << setw(11) << vertexOrderName(order)
+                 << setw(12) << chrono::duration<double, milli>(t1 - t0).count() << setw(9) << averageLogGap(g.csr())
+                 << setw(10) << times.bfsMillis << setw(9) << base.bfsMillis / times.bfsMillis
+                 << setw(13) << times.dijkstraMillis << setw(9) << base.dijkstraMillis / times.dijkstraMillis
+                 << "  " << (same ? "yes" : "NO") << endl;
+        }
+    }
+    return allOk;
+}
+
+// 堆和桶队列两种Dijkstra的对比：边权1到100的网格图适合桶队列；边权为2^20的长路径上
+// 逐个扫描空桶的代价是V·C，shortestPathsBucket应当改用堆，两列时间接近。返回结果是否一致
+bool runBucketBenchmark(int vertices) {
+    Graph road = generateGraph(GraphShape::Road, vertices, 2024);
+    Graph path(vertices);
+    for (int v = 0; v + 1 < vertices; v++) path.addEdge(v, v + 1, 1 << 20);
+    path.freeze();
+    const char* names[] = { "road", "path" };
+    Graph* graphs[] = { &road, &path };
+    bool allOk = true;
+    cout << fixed << setprecision(2);
+    cout << setw(10) << "graph" << setw(12) << "max weight" << setw(10) << "heap ms" << setw(11) << "bucket ms"
+         << "  same result" << endl;
+    for (int k = 0; k < 2; k++) {
+        Graph& g = *graphs[k];
+        const CSR& adj = g.csr();
+        int maxWeight = 0;
+        for (long long i = 0; i < adj.size(); i++) maxWeight = max(maxWeight, adj.weight[i]);
+        auto t0 = chrono::steady_clock::now();
+        ShortestPaths heap = g.shortestPaths(0);
+        auto t1 = chrono::steady_clock::now();
+        ShortestPaths bucket = g.shortestPathsBucket(0);
+        auto t2 = chrono::steady_clock::now();
+        bool same = heap.dist == bucket.dist;
+        allOk = allOk && same;
+        cout << setw(10) << names[k] << setw(12) << maxWeight
+             << setw(10) << chrono::duration<double, milli>(t1 - t0).count()
+             << setw(11) << chrono::duration<double, milli>(t2 - t1).count()
+             << "  " << (same ? "yes" : "NO") << endl;
+    }
+    return allOk;
+}
+
+// 命令行工具：
+//   stats <图文件> [线程数]           载入图并输出规模和载入时间
+//   snapshot <图文件> <输出> [线程数]  转换成可以直接映射的二进制快照
+//   bench [顶点数]                    顶点重排前后的遍历速度对比，以及堆和桶队列Dijkstra的对比
+int runTool(int argc, char* argv[]) {
+    string command = argv[1];
+    if (command == "bench") {
+        int vertices = argc > 2 ? stoi(argv[2]) : 1 << 20;
+        bool ok = runReorderBenchmark(vertices);
+        cout << endl;
+        ok = runBucketBenchmark(vertices) && ok;
+        return ok ? 0 : 1;
+    }
+    bool known = command == "stats" || command == "snapshot";
+    if (!known || argc < 3 || (command == "snapshot" && argc < 4)) {
+        cerr << "usage: " << argv[0] << " stats <graph> [threads]" << endl;
+        cerr << "       " << argv[0] << " snapshot <graph> <output> [threads]" << endl;
+        cerr << "       " << argv[0] << " bench [vertices]" << endl;
+        return 2;
+    }
+    int threadArg = (command == "stats") ? 3 : 4;
+    int threads = (argc > threadArg) ? stoi(argv[threadArg]) : defaultThreads();
+    Graph g(0);
+    auto t0 = chrono::steady_clock::now();
+    if (!g.load(argv[2], threads)) {
+        cerr << "cannot load " << argv[2] << endl;
+        return 1;
+    }
+    auto t1 = chrono::steady_clock::now();
+    cout << argv[2] << ": " << g.vertexCount() << " vertices, " << g.csr().size() << " adjacency entries, loaded in "
+         << chrono::duration<double>(t1 - t0).count() << " s" << endl;
+    if (command == "snapshot" && !g.saveSnapshot(argv[3])) {
+        cerr << "cannot write " << argv[3] << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 测试主函数：带参数时作为命令行工具
+int main(int argc, char* argv[]) {
+    if (argc > 1) return runTool(argc, argv);
+
     // 创建一个具有6个顶点的图
     Graph g(6);
 
@@ -185,11 +2387,69 @@ int main() {
     g.BFS(0);
     g.DFS(0);
 
+    int components;
+    g.connectedComponents(components);
+    Biconnectivity bc = g.biconnectivity();
+    cout << "Components: " << components << ", has cycle: " << (g.hasCycle() ? "yes" : "no")
+         << ", articulation points: " << bc.articulationPoints.size() << ", bridges: " << bc.bridges.size() << endl;
+
+    BFSResult levels = g.parallelBFS(0, 2);
+    cout << "BFS levels from vertex 0:";
+    for (int v = 0; v < 6; v++) cout << " " << levels.dist[v];
+    cout << endl;
+
     cout << "\nTesting Dijkstra's shortest path:\n";
     g.dijkstra(0);
 
+    ShortestPaths sp = g.shortestPathsBucket(0, 5);
+    cout << "Path from 0 to 5 (distance " << sp.dist[5] << "):";
+    for (int v : sp.pathTo(5)) cout << " " << v;
+    cout << endl;
+
+    DistanceMatrix matrix = g.distanceMatrix({ 0, 5 }, { 0, 3, 5 }, 2);
+    DistanceMatrix all = g.floydWarshall(2);
+    cout << "Distance matrix from {0, 5} to {0, 3, 5}:";
+    for (int i = 0; i < matrix.rows; i++) {
+        for (int j = 0; j < matrix.cols; j++) cout << " " << matrix.at(i, j);
+        cout << (i + 1 < matrix.rows ? ";" : "");
+    }
+    cout << " (Floyd-Warshall 0 to 5: " << all.at(0, 5) << ")" << endl;
+
+    g.buildLandmarks(2);
+    PathResult bidir = g.shortestPath(0, 5);
+    PathResult alt = g.shortestPathALT(0, 5);
+    cout << "Bidirectional: distance " << bidir.distance << ", settled " << bidir.settled
+         << "; ALT: distance " << alt.distance << ", settled " << alt.settled << endl;
+
+    ContractionHierarchy ch;
+    ch.build(g.csr());
+    cout << "Contraction hierarchy: " << ch.edgeCount() << " upward edges, distance 0 to 5 = "
+         << ch.distance(0, 5) << endl;
+
+    Graph reordered = g;
+    Relabeling rcm = reordered.reorder(VertexOrder::RCM);
+    ShortestPaths fromZero = reordered.shortestPaths(rcm.oldToNew[0]);
+    cout << "After RCM relabeling, path from 0 to 5:";
+    for (int v : rcm.originalIds(fromZero.pathTo(rcm.oldToNew[5]))) cout << " " << v;
+    cout << endl;
+
+    cout << "\nTesting directed graph:\n";
+    Graph dg(6, true);
+    for (const Edge& e : g.edgeList()) dg.addEdge(e.u, e.v, e.weight);
+    cout << "Topological order:";
+    for (int v : dg.topologicalOrder()) cout << " " << v;
+    cout << endl;
+    ShortestPaths tree = dg.shortestPaths(0);
+    cout << "Distance 0 to 5: " << tree.dist[5];
+    dg.updateWeight(3, 4, 20, tree);
+    cout << ", after 3->4 becomes 20: " << tree.dist[5];
+    dg.updateWeight(2, 4, 1, tree);
+    cout << ", after 2->4 becomes 1: " << tree.dist[5] << endl;
+
     cout << "\nTesting Prim's MST:\n";
     g.primMST();
+    cout << "Kruskal total: " << g.kruskalForest().totalWeight << ", Boruvka total: "
+         << g.boruvkaForest(2).totalWeight << endl;
 
     return 0;
 }